@@ -124,6 +124,10 @@ public:
         return emptyCount_ == 0;
     }
 
+    int emptyCount() const {
+        return emptyCount_;
+    }
+
     DynamicArray<Coord> getEmptyCells() const {
         DynamicArray<Coord> result;
         for (int row = 0; row < rows_; ++row) {
@@ -308,6 +312,37 @@ public:
         return total;
     }
 
+    // Windows of winLength cells holding no stone of the opponent and not yet
+    // completed by `who`, i.e. lines `who` could still make. With maxMissing >= 0
+    // only windows needing at most that many more stones are counted.
+    int liveWindowCount(CellState who, int maxMissing = -1) const {
+        if (who == CellState::Empty) return 0;
+        CellState opp = (who == CellState::X) ? CellState::O : CellState::X;
+        int live = 0;
+        int dirs[4][2] = { {1,0},{0,1},{1,1},{1,-1} };
+        for (auto& d : dirs) {
+            int dr = d[0], dc = d[1];
+            for (int row = 0; row < rows_; ++row) {
+                for (int col = 0; col < cols_; ++col) {
+                    int er = row + (winLength_ - 1) * dr;
+                    int ec = col + (winLength_ - 1) * dc;
+                    if (er < 0 || er >= rows_ || ec < 0 || ec >= cols_) continue;
+                    int own = 0;
+                    bool blocked = false;
+                    for (int k = 0; k < winLength_ && !blocked; ++k) {
+                        CellState s = getNoCheck(row + k * dr, col + k * dc);
+                        if (s == opp) blocked = true;
+                        else if (s == who) ++own;
+                    }
+                    if (blocked || own == winLength_) continue;
+                    if (maxMissing >= 0 && winLength_ - own > maxMissing) continue;
+                    ++live;
+                }
+            }
+        }
+        return live;
+    }
+
 
     void print() const {
         std::cout << "  ";
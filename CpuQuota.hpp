@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+class CpuQuota {
+public:
+    static constexpr unsigned int DEFAULT_THREAD_CAP = 4;
+    // Explicit budgets may oversubscribe the CPUs, but not without bound.
+    static constexpr unsigned int MAX_THREAD_BUDGET = 32;
+
+    // cgroup v2: "<quota> <period>" or "max <period>". Returns 0 when unlimited or unreadable.
+    static unsigned int readCgroupV2(const std::string& root) {
+        std::ifstream in(root + "/cpu.max");
+        if (!in.is_open()) return 0;
+        std::string quota;
+        long long period = 0;
+        if (!(in >> quota >> period)) return 0;
+        if (quota == "max" || period <= 0) return 0;
+        long long q = 0;
+        try {
+            q = std::stoll(quota);
+        } catch (...) {
+            return 0;
+        }
+        return cpusFromQuota(q, period);
+    }
+
+    // cgroup v1: cpu.cfs_quota_us / cpu.cfs_period_us, quota -1 means unlimited.
+    static unsigned int readCgroupV1(const std::string& root) {
+        const char* dirs[] = { "/cpu", "/cpu,cpuacct", "/cpuacct,cpu", "" };
+        for (const char* dir : dirs) {
+            std::ifstream quotaIn(root + dir + "/cpu.cfs_quota_us");
+            std::ifstream periodIn(root + dir + "/cpu.cfs_period_us");
+            if (!quotaIn.is_open() || !periodIn.is_open()) continue;
+            long long q = 0;
+            long long period = 0;
+            if (!(quotaIn >> q) || !(periodIn >> period)) continue;
+            return cpusFromQuota(q, period);
+        }
+        return 0;
+    }
+
+    static unsigned int readCgroupQuota(const std::string& root) {
+        unsigned int v2 = readCgroupV2(root);
+        if (v2 > 0) return v2;
+        return readCgroupV1(root);
+    }
+
+    static unsigned int affinityCount() {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            int n = CPU_COUNT(&set);
+            if (n > 0) return static_cast<unsigned int>(n);
+        }
+#endif
+        return 0;
+    }
+
+    static unsigned int detect(const std::string& cgroupRoot = "/sys/fs/cgroup") {
+        unsigned int cpus = affinityCount();
+        if (cpus == 0) cpus = std::thread::hardware_concurrency();
+        unsigned int quota = readCgroupQuota(cgroupRoot);
+        if (quota > 0 && (cpus == 0 || quota < cpus)) cpus = quota;
+        return cpus;
+    }
+
+    // Detected once per process; the quota of a running container does not change under us.
+    static unsigned int effectiveCpus() {
+        static const unsigned int cached = detect();
+        return cached;
+    }
+
+    // requested > 0 is an explicit budget (at most MAX_THREAD_BUDGET); 0 means
+    // "auto" (effective CPUs, capped).
+    static unsigned int resolveThreadBudget(int requested, unsigned int cpus) {
+        if (requested > 0) return std::min(static_cast<unsigned int>(requested), MAX_THREAD_BUDGET);
+        if (cpus == 0) return 2;
+        return std::min(cpus, DEFAULT_THREAD_CAP);
+    }
+
+private:
+    static unsigned int cpusFromQuota(long long quota, long long period) {
+        if (quota <= 0 || period <= 0) return 0;
+        long long cpus = (quota + period - 1) / period;
+        return static_cast<unsigned int>(std::max(1LL, cpus));
+    }
+};
@@ -0,0 +1,246 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Weights of the window evaluator for one (rows, cols, winLen, mode): window[n] is
+// the score of a window holding n stones of one side and none of the other, and
+// cells[row * cols + col] the bonus for a stone on that cell. Files carry window[1]
+// .. window[winLen - 1]; the weight of a complete window stays the engine's own.
+class EvalWeights {
+public:
+    // MinimaxAI::WIN_SCORE; a sixteenth of it is the Classic complete-window weight.
+    static constexpr int ENGINE_WIN_SCORE = 1000000000;
+
+    int rows = 0;
+    int cols = 0;
+    int winLen = 0;
+    GameMode mode = GameMode::Classic;
+    DynamicArray<int> window;
+    DynamicArray<int> cells;
+
+    // The hand-set tables the evaluator has always used.
+    static EvalWeights defaults(int rows, int cols, int winLen, GameMode mode, int winScore) {
+        EvalWeights w;
+        w.rows = rows;
+        w.cols = cols;
+        w.winLen = winLen;
+        w.mode = mode;
+        w.window.reserve(static_cast<size_t>(winLen + 1));
+        w.window.push_back(0);
+        if (mode == GameMode::Classic) {
+            for (int i = 1; i <= winLen; ++i) {
+                int v = i * i * winLen;
+                if (i == winLen - 1) {
+                    v += winLen * winLen * 4;
+                }
+                if (i == winLen) {
+                    v = winScore / 16;
+                }
+                w.window.push_back(v);
+            }
+        } else {
+            int linesWin = 2000 + winLen * 80;
+            for (int i = 1; i <= winLen; ++i) {
+                int v = i * i * winLen * 3;
+                if (i == winLen - 1) {
+                    v += winLen * winLen * 2;
+                }
+                if (i == winLen) {
+                    v = linesWin;
+                }
+                w.window.push_back(v);
+            }
+        }
+
+        int centerRow = rows / 2;
+        int centerCol = cols / 2;
+        int minSide = std::min(rows, cols);
+        w.cells.reserve(static_cast<size_t>(rows * cols));
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                int centerDist = std::abs(row - centerRow) + std::abs(col - centerCol);
+                w.cells.push_back(minSide - centerDist);
+            }
+        }
+        return w;
+    }
+
+    bool matches(int r, int c, int k, GameMode m) const {
+        return r == rows && c == cols && k == winLen && m == mode;
+    }
+
+    // The weight the engine gives a complete window; file weights stay below it.
+    static int completeWindow(int winLen, GameMode mode) {
+        return defaults(1, 1, winLen, mode, ENGINE_WIN_SCORE).window[static_cast<size_t>(winLen)];
+    }
+};
+
+// A weights file holds any number of blocks of the form
+//     weights <rows> <cols> <winLen> <classic|lines>
+//     window <w1> ... <w_(winLen-1)>
+//     cells <rows * cols values, row-major>
+// Lines starting with '#' are comments. Window weights must be positive, strictly
+// increasing and below the engine's complete-window weight, and boards at most
+// MAX_SIDE on a side; a file breaking that is rejected as a whole.
+class EvalWeightSet {
+public:
+    static constexpr int MAX_SIDE = 32;
+
+    bool empty() const { return entries_.empty(); }
+    size_t size() const { return entries_.size(); }
+    const EvalWeights& at(size_t i) const { return entries_[i]; }
+
+    const EvalWeights* find(int rows, int cols, int winLen, GameMode mode) const {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].matches(rows, cols, winLen, mode)) return &entries_[i];
+        }
+        return nullptr;
+    }
+
+    void set(const EvalWeights& w) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].matches(w.rows, w.cols, w.winLen, w.mode)) {
+                entries_[i] = w;
+                return;
+            }
+        }
+        entries_.push_back(w);
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return false;
+        DynamicArray<EvalWeights> parsed;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            std::string tag;
+            if (!(ls >> tag) || tag[0] == '#') continue;
+            if (tag != "weights") return false;
+            EvalWeights w;
+            std::string mode;
+            if (!(ls >> w.rows >> w.cols >> w.winLen >> mode)) return false;
+            if (w.rows <= 0 || w.cols <= 0 || w.rows > MAX_SIDE || w.cols > MAX_SIDE || w.winLen <= 0 ||
+                w.winLen > std::max(w.rows, w.cols) || (mode != "classic" && mode != "lines")) {
+                return false;
+            }
+            w.mode = (mode == "classic") ? GameMode::Classic : GameMode::LinesScore;
+            w.window.push_back(0);
+            if (!readRow(in, "window", static_cast<size_t>(w.winLen - 1), w.window)) return false;
+            // The search reads the window weights as a threat scale: positive and
+            // increasing with the stone count, as eval_tuner fits them.
+            for (int n = 1; n < w.winLen; ++n) {
+                if (w.window[static_cast<size_t>(n)] <= w.window[static_cast<size_t>(n - 1)]) return false;
+            }
+            if (w.window[static_cast<size_t>(w.winLen - 1)] >= EvalWeights::completeWindow(w.winLen, w.mode)) return false;
+            if (!readRow(in, "cells", static_cast<size_t>(w.rows * w.cols), w.cells)) return false;
+            parsed.push_back(w);
+        }
+        for (size_t i = 0; i < parsed.size(); ++i) set(parsed[i]);
+        return !parsed.empty();
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+        out << "# tictactoe2 window evaluator weights\n";
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const EvalWeights& w = entries_[i];
+            out << "weights " << w.rows << " " << w.cols << " " << w.winLen << " "
+                << (w.mode == GameMode::Classic ? "classic" : "lines") << "\n";
+            out << "window";
+            for (int k = 1; k < w.winLen; ++k) out << " " << w.window[static_cast<size_t>(k)];
+            out << "\ncells";
+            for (size_t k = 0; k < w.cells.size(); ++k) out << " " << w.cells[k];
+            out << "\n";
+        }
+        return static_cast<bool>(out);
+    }
+
+private:
+    DynamicArray<EvalWeights> entries_;
+
+    static bool readRow(std::istream& in, const char* tag, size_t count, DynamicArray<int>& out) {
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            std::string t;
+            if (!(ls >> t) || t[0] == '#') continue;
+            if (t != tag) return false;
+            int v = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (!(ls >> v)) return false;
+                out.push_back(v);
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// One self-play position for tuning: the board, the lines already credited, and
+// the final result from X's point of view (1 win, 0.5 draw, 0 loss).
+class TuningPosition {
+public:
+    int rows = 0;
+    int cols = 0;
+    int winLen = 0;
+    GameMode mode = GameMode::Classic;
+    int scoreX = 0;
+    int scoreO = 0;
+    std::string cells;
+    double result = 0.5;
+
+    // Quiet: no empty cell completes a line for either side, so the static
+    // evaluation is not about to be overturned by a single move.
+    static bool isQuiet(const Board& board) {
+        for (int r = 0; r < board.getRows(); ++r) {
+            for (int c = 0; c < board.getCols(); ++c) {
+                if (board.getNoCheck(r, c) != CellState::Empty) continue;
+                Coord mv(r, c);
+                if (board.checkWinFromMove(mv, CellState::X) || board.checkWinFromMove(mv, CellState::O)) return false;
+            }
+        }
+        return true;
+    }
+
+    static TuningPosition fromBoard(const Board& board, GameMode mode, int scoreX, int scoreO) {
+        TuningPosition p;
+        p.rows = board.getRows();
+        p.cols = board.getCols();
+        p.winLen = board.getWinLength();
+        p.mode = mode;
+        p.scoreX = scoreX;
+        p.scoreO = scoreO;
+        p.cells.reserve(static_cast<size_t>(p.rows * p.cols));
+        for (int r = 0; r < p.rows; ++r) {
+            for (int c = 0; c < p.cols; ++c) {
+                CellState s = board.getNoCheck(r, c);
+                p.cells.push_back(s == CellState::X ? 'X' : (s == CellState::O ? 'O' : '.'));
+            }
+        }
+        return p;
+    }
+
+    // <rows> <cols> <winLen> <classic|lines> <scoreX> <scoreO> <cells> <result>
+    std::string format() const {
+        std::ostringstream out;
+        out << rows << " " << cols << " " << winLen << " " << (mode == GameMode::Classic ? "classic" : "lines")
+            << " " << scoreX << " " << scoreO << " " << cells << " " << result;
+        return out.str();
+    }
+
+    bool parse(const std::string& line) {
+        std::istringstream in(line);
+        std::string m;
+        if (!(in >> rows >> cols >> winLen >> m >> scoreX >> scoreO >> cells >> result)) return false;
+        if (m != "classic" && m != "lines") return false;
+        mode = (m == "classic") ? GameMode::Classic : GameMode::LinesScore;
+        return rows > 0 && cols > 0 && winLen > 0 && cells.size() == static_cast<size_t>(rows * cols);
+    }
+};
@@ -10,6 +10,8 @@
 #include <mutex>
 #include <cmath>
 #include <chrono>
+#include <thread>
+#include <random>
 
 
 enum class MoveStatus {
@@ -19,9 +21,11 @@ enum class MoveStatus {
     GameAlreadyOver
 };
 
+// Mcts keeps the Fast move generation and switches the search to SearchEngine::Mcts.
 enum class EnginePreset {
     Fast,
-    Strict
+    Strict,
+    Mcts
 };
 
 enum class OpeningRule {
@@ -123,12 +127,30 @@ public:
         aiB_.setMoveGenMode(moveGenMode_);
         aiA_.setUseLMR(useLMR_);
         aiB_.setUseLMR(useLMR_);
+        aiA_.setUseNullMove(useNullMove_);
+        aiB_.setUseNullMove(useNullMove_);
+        aiA_.setUseProbCut(useProbCut_);
+        aiB_.setUseProbCut(useProbCut_);
+        aiA_.setEvalBackend(evalBackend_);
+        aiB_.setEvalBackend(evalBackend_);
+        aiA_.setNeuralNet(neuralNet());
+        aiB_.setNeuralNet(neuralNet());
+        aiA_.setEvalWeights(evalWeights());
+        aiB_.setEvalWeights(evalWeights());
+        aiA_.setSearchEngine(searchEngine_);
+        aiB_.setSearchEngine(searchEngine_);
         aiA_.setUseExtensions(useExtensions_);
         aiB_.setUseExtensions(useExtensions_);
         aiA_.setPerfectClassic3(perfectClassic3_);
         aiB_.setPerfectClassic3(perfectClassic3_);
-        aiA_.setAllowOpeningShortcut(enginePreset_ == EnginePreset::Fast);
-        aiB_.setAllowOpeningShortcut(enginePreset_ == EnginePreset::Fast);
+        aiA_.setAllowOpeningShortcut(enginePreset_ != EnginePreset::Strict);
+        aiB_.setAllowOpeningShortcut(enginePreset_ != EnginePreset::Strict);
+        aiA_.setThreadBudget(threadBudget_);
+        aiB_.setThreadBudget(threadBudget_);
+    }
+
+    ~GameController() {
+        stopPondering();
     }
 
     void setOnAIMoveCallback(const std::function<void(const Board&, Player, const MoveEvaluation&, const AIStatistics&)>& cb)
@@ -139,9 +161,11 @@ public:
 
     void newGame(int rows, int cols, int winLength, GameMode mode, OpeningRule openingRule = OpeningRule::None) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
         board_ = Board(rows, cols, winLength);
         mode_ = mode;
         gameOver_ = false;
+        finishedEarly_ = false;
         moveNumber_ = 0;
         creditedLinesX_ = 0;
         creditedLinesO_ = 0;
@@ -155,16 +179,34 @@ public:
         aiB_.setMoveGenMode(moveGenMode_);
         aiA_.setUseLMR(useLMR_);
         aiB_.setUseLMR(useLMR_);
+        aiA_.setUseNullMove(useNullMove_);
+        aiB_.setUseNullMove(useNullMove_);
+        aiA_.setUseProbCut(useProbCut_);
+        aiB_.setUseProbCut(useProbCut_);
+        aiA_.setEvalBackend(evalBackend_);
+        aiB_.setEvalBackend(evalBackend_);
+        aiA_.setNeuralNet(neuralNet());
+        aiB_.setNeuralNet(neuralNet());
+        aiA_.setEvalWeights(evalWeights());
+        aiB_.setEvalWeights(evalWeights());
+        aiA_.setSearchEngine(searchEngine_);
+        aiB_.setSearchEngine(searchEngine_);
         aiA_.setUseExtensions(useExtensions_);
         aiB_.setUseExtensions(useExtensions_);
         aiA_.setPerfectClassic3(perfectClassic3_);
         aiB_.setPerfectClassic3(perfectClassic3_);
-        aiA_.setAllowOpeningShortcut(enginePreset_ == EnginePreset::Fast);
-        aiB_.setAllowOpeningShortcut(enginePreset_ == EnginePreset::Fast);
+        aiA_.setAllowOpeningShortcut(enginePreset_ != EnginePreset::Strict);
+        aiB_.setAllowOpeningShortcut(enginePreset_ != EnginePreset::Strict);
+        aiA_.setThreadBudget(threadBudget_);
+        aiB_.setThreadBudget(threadBudget_);
+        applyDeterminism(aiA_);
+        applyDeterminism(aiB_);
+        resetClocks();
     }
 
     void setMoveGenMode(MoveGenMode mode) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
         moveGenMode_ = mode;
         aiA_.setMoveGenMode(moveGenMode_);
         aiB_.setMoveGenMode(moveGenMode_);
@@ -172,13 +214,81 @@ public:
 
     void setUseLMR(bool v) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
         useLMR_ = v;
         aiA_.setUseLMR(useLMR_);
         aiB_.setUseLMR(useLMR_);
     }
 
+    void setUseNullMove(bool v) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        useNullMove_ = v;
+        aiA_.setUseNullMove(useNullMove_);
+        aiB_.setUseNullMove(useNullMove_);
+    }
+
+    void setUseProbCut(bool v) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        useProbCut_ = v;
+        aiA_.setUseProbCut(useProbCut_);
+        aiB_.setUseProbCut(useProbCut_);
+    }
+
+    void setEvalBackend(EvalBackend b) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        evalBackend_ = b;
+        aiA_.setEvalBackend(evalBackend_);
+        aiB_.setEvalBackend(evalBackend_);
+    }
+
+    // Weights for EvalBackend::Neural. The previous network is kept when the file
+    // cannot be read.
+    bool loadEvalWeights(const std::string& path) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        NeuralNet net;
+        if (!net.load(path)) return false;
+        aiA_.setNeuralNet(nullptr);
+        aiB_.setNeuralNet(nullptr);
+        evalNet_ = std::move(net);
+        aiA_.setNeuralNet(neuralNet());
+        aiB_.setNeuralNet(neuralNet());
+        return true;
+    }
+    bool hasEvalWeights() const { return evalNet_.ready(); }
+
+    // Tuned window evaluator weights (see eval_tuner). Blocks for other geometries
+    // are kept, so one file can serve every board size.
+    bool loadWindowWeights(const std::string& path) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        EvalWeightSet set;
+        if (!set.load(path)) return false;
+        aiA_.setEvalWeights(nullptr);
+        aiB_.setEvalWeights(nullptr);
+        windowWeights_ = std::move(set);
+        aiA_.setEvalWeights(evalWeights());
+        aiB_.setEvalWeights(evalWeights());
+        return true;
+    }
+    bool hasWindowWeights() const { return !windowWeights_.empty(); }
+
+    // runAIVsAIGame appends its quiet positions, labelled with the final result, to
+    // this file (empty: off). openingPlies random moves near the centre start each
+    // game so repeated self-play does not replay one game.
+    void setPositionDump(const std::string& path, int openingPlies = 0, unsigned seed = 1) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        positionDumpPath_ = path;
+        randomOpeningPlies_ = std::max(0, openingPlies);
+        openingRng_.seed(seed);
+    }
+
     void setUseExtensions(bool v) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
         useExtensions_ = v;
         aiA_.setUseExtensions(useExtensions_);
         aiB_.setUseExtensions(useExtensions_);
@@ -186,11 +296,57 @@ public:
 
     void setPerfectClassic3(bool v) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
         perfectClassic3_ = v;
         aiA_.setPerfectClassic3(perfectClassic3_);
         aiB_.setPerfectClassic3(perfectClassic3_);
     }
 
+    void setThreadBudget(int threads) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        threadBudget_ = std::max(0, threads);
+        aiA_.setThreadBudget(threadBudget_);
+        aiB_.setThreadBudget(threadBudget_);
+    }
+
+    int threadBudget() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return threadBudget_;
+    }
+
+    void setDeterministicSearch(bool v, uint64_t iterationNodeBudget = 0) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        deterministic_ = v;
+        iterationNodeBudget_ = v ? iterationNodeBudget : 0;
+        applyDeterminism(aiA_);
+        applyDeterminism(aiB_);
+    }
+
+    bool deterministicSearch() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return deterministic_;
+    }
+
+    // End the game as soon as its result is settled: in LinesScore once the remaining
+    // live windows can no longer change the winner (the score stays as credited),
+    // in Classic once neither side can complete a window (a draw).
+    void setEarlyFinish(bool v) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        earlyFinish_ = v;
+    }
+
+    bool earlyFinish() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return earlyFinish_;
+    }
+
+    bool finishedEarly() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return finishedEarly_;
+    }
+
     void setEnginePreset(EnginePreset preset, int boardRows = -1, int boardCols = -1) {
         std::lock_guard<std::recursive_mutex> lk(stateMutex_);
         enginePreset_ = preset;
@@ -210,8 +366,11 @@ public:
         setUseLMR(lmr);
         setUseExtensions(ext);
         setPerfectClassic3(perfect);
-        aiA_.setAllowOpeningShortcut(preset == EnginePreset::Fast);
-        aiB_.setAllowOpeningShortcut(preset == EnginePreset::Fast);
+        aiA_.setAllowOpeningShortcut(preset != EnginePreset::Strict);
+        aiB_.setAllowOpeningShortcut(preset != EnginePreset::Strict);
+        searchEngine_ = (preset == EnginePreset::Mcts) ? SearchEngine::Mcts : SearchEngine::AlphaBeta;
+        aiA_.setSearchEngine(searchEngine_);
+        aiB_.setSearchEngine(searchEngine_);
     }
 
     EnginePreset enginePreset() const { return enginePreset_; }
@@ -801,11 +960,388 @@ public:
             }
         }
 
-        return count;
+        return count;
+    }
+
+    
+    // The search for a move the seat is about to play: its time is charged to the seat's clock.
+    MoveEvaluation findBestMoveForSeat(Seat seat, Player sideToMove, int depth, bool useMemoization, AIStatistics& outStats, MoveEvaluation* bestSoFar = nullptr, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMs = -1)
+    {
+        auto start = std::chrono::steady_clock::now();
+        MoveEvaluation eval = searchForSeat(seat, sideToMove, depth, useMemoization, outStats, bestSoFar, cancelFlag, timeLimitMs);
+        auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start).count();
+        chargeClock(seat, spent);
+        return eval;
+    }
+
+    // Hints and analysis: no move is played, so the clock is left alone.
+    MoveEvaluation findBestMove(Player aiPlayer, int depth, bool useMemoization, AIStatistics& outStats, MoveEvaluation* bestSoFar = nullptr, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMs = -1)
+    {
+        return searchForSeat(seatOf(aiPlayer), aiPlayer, depth, useMemoization, outStats, bestSoFar, cancelFlag, timeLimitMs);
+    }
+
+    // totalMs <= 0 disables the game clock; searches are then bounded only by timeLimitMs.
+    void setTimeControl(int totalMs, int incrementMs = 0) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        timeControlMs_ = totalMs;
+        timeIncrementMs_ = std::max(0, incrementMs);
+        resetClocks();
+    }
+
+    int timeControlMs() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return timeControlMs_;
+    }
+
+    int timeIncrementMs() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return timeIncrementMs_;
+    }
+
+    int remainingTimeMs(Seat seat) const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        if (timeControlMs_ <= 0) return -1;
+        return seatClockMs_[seat == Seat::A ? 0 : 1];
+    }
+
+    void setPonderEnabled(bool v) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        ponderEnabled_ = v;
+        if (!v) stopPondering();
+    }
+
+    bool ponderEnabled() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return ponderEnabled_;
+    }
+
+    bool isPondering() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return ponder_.active;
+    }
+
+    Coord ponderExpectedReply() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return ponder_.active ? ponder_.expectedReply : Coord(-1, -1);
+    }
+
+    int ponderHits() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return ponderHits_;
+    }
+
+    int ponderMisses() const {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        return ponderMisses_;
+    }
+
+    
+    bool startPondering(Seat seat, int depth, bool useMemoization, int timeLimitMs = -1) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        stopPondering();
+        if (!ponderEnabled_ || gameOver_ || openingPhase_ != OpeningPhase::Normal) return false;
+        Player side = sideOf(seat);
+        if (currentPlayer_ == side) return false;
+        if (openingRule_ == OpeningRule::PieSwap && moveNumber_ <= 1) return false;
+
+        MinimaxAI& ai = aiForSeat(seat);
+        ai.setPlayer(side);
+        ai.setUseMemoization(useMemoization);
+        Coord reply = ai.predictReply(board_, currentPlayer_, creditedLinesX_, creditedLinesO_);
+        if (reply.row() < 0 || reply.col() < 0) return false;
+
+        Board predicted = board_;
+        int sx = creditedLinesX_;
+        int so = creditedLinesO_;
+        CellState replyCell = playerToCell(currentPlayer_);
+        applyTempMove(predicted, reply, replyCell, sx, so);
+        if (predicted.isFull()) return false;
+        if (mode_ == GameMode::Classic && predicted.checkWinFromMove(reply, replyCell)) return false;
+
+        ponder_.seat = seat;
+        ponder_.side = side;
+        ponder_.expectedReply = reply;
+        ponder_.board = predicted;
+        ponder_.scoreX = sx;
+        ponder_.scoreO = so;
+        ponder_.result = MoveEvaluation();
+        ponder_.bestSoFar = MoveEvaluation(Coord(-1, -1), std::numeric_limits<int>::min());
+        ponder_.stats.reset();
+        ponder_.cancel.store(false, std::memory_order_relaxed);
+        ponder_.done.store(false, std::memory_order_relaxed);
+        ponder_.active = true;
+
+        ai.setMaxDepth(depth);
+        ai.setCancelFlag(&ponder_.cancel);
+        ai.setBestSoFar(&ponder_.bestSoFar);
+        ai.setCredits(sx, so);
+        ai.setTimeLimitMs(timeLimitMs);
+        ai.setGameClock(-1, 0);
+        ai.setMoveGenMode(moveGenMode_);
+        ai.setUseLMR(useLMR_);
+        ai.setUseNullMove(useNullMove_);
+        ai.setUseProbCut(useProbCut_);
+        ai.setEvalBackend(evalBackend_);
+        ai.setNeuralNet(neuralNet());
+        ai.setEvalWeights(evalWeights());
+        ai.setSearchEngine(searchEngine_);
+        ai.setUseExtensions(useExtensions_);
+        ai.setPerfectClassic3(perfectClassic3_);
+        ai.setBanCenterFirstMove(openingRule_ == OpeningRule::None);
+
+        ponderThread_ = std::thread([this, &ai]() {
+            Board searchBoard = ponder_.board;
+            MoveEvaluation eval = ai.findBestMove(searchBoard);
+            ponder_.result = eval;
+            ponder_.stats = ai.getStatistics();
+            ponder_.done.store(true, std::memory_order_release);
+        });
+        return true;
+    }
+
+    void stopPondering() {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        if (!ponder_.active) return;
+        ponder_.cancel.store(true, std::memory_order_relaxed);
+        if (ponderThread_.joinable()) {
+            ponderThread_.join();
+        }
+        MinimaxAI& ai = aiForSeat(ponder_.seat);
+        ai.setCancelFlag(nullptr);
+        ai.setBestSoFar(nullptr);
+        ai.keepTranspositionsForNextSearch();
+        ponder_.active = false;
+    }
+
+    
+    AIVsAIResult runAIVsAIGame(int depthX, bool memoX, int depthO, bool memoO, const std::string& csvFilename, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMsX = -1, int timeLimitMsO = -1)
+    {
+        int rows   = board_.getRows();
+        int cols   = board_.getCols();
+        int winLen = board_.getWinLength();
+        newGame(rows, cols, winLen, mode_, openingRule_);
+
+        AIVsAIResult result{};
+        result.mode = mode_;
+        result.finalLinesX = 0;
+        result.finalLinesO = 0;
+        result.finalScore = 0;
+        result.xWins = false;
+        result.oWins = false;
+        result.draw = false;
+        result.moves.clear();
+
+        std::ofstream csv(csvFilename);
+        if (csv.is_open()) {
+            csv << "Move,Player,Row,Col,EvalScore,"
+                   "NodesVisited,NodesGenerated,CacheHits,CacheMisses,TimeMs\n";
+        }
+
+        int moveIndex = 0;
+        if (randomOpeningPlies_ > 0 && openingPhase_ == OpeningPhase::Normal) {
+            playRandomOpening(randomOpeningPlies_);
+        }
+        DynamicArray<TuningPosition> dumped;
+
+        while (!gameOver_) {
+            if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) {
+                break;
+            }
+            ++moveIndex;
+            Seat chooser = seatToMove_;
+            Player sideToMove = currentPlayer_;
+            int  depth = (chooser == Seat::A) ? depthX : depthO;
+            bool memo  = (chooser == Seat::A) ? memoX : memoO;
+
+        if (openingPhase_ != OpeningPhase::Normal) {
+            Player chooserSide = sideOf(chooser);
+                if (autoResolveOpeningChoiceForCurrentAI(depth, memo, cancelFlag)) {
+                    AIVsAIMoveInfo info;
+                    info.isSwap   = true;
+                    info.seat     = lastOpeningChoiceSeat_;
+                    info.phase    = lastOpeningChoicePhase_;
+                    info.action   = lastOpeningChoiceAction_;
+                    info.player   = chooserSide;
+                    info.move     = Coord(-1, -1);
+                    info.evalScore = 0;
+                    info.stats    = AIStatistics();
+                result.moves.push_back(info);
+                    if (csv.is_open()) {
+                        csv << moveIndex << ",CHOICE,,,,,,,,\n";
+                    }
+                    continue;
+                }
+            }
+
+            AIStatistics stats;
+            int timeLimit = (chooser == Seat::A) ? timeLimitMsX : timeLimitMsO;
+            MoveEvaluation bestSoFar(Coord(-1, -1), std::numeric_limits<int>::min());
+            MoveEvaluation eval = findBestMoveForSeat(chooser, sideToMove, depth, memo, stats, &bestSoFar, cancelFlag, timeLimit);
+
+            auto isUsableMove = [&](const MoveEvaluation& mv) {
+                if (mv.move.row() < 0 || mv.move.col() < 0) return false;
+                int rows = board_.getRows();
+                int cols = board_.getCols();
+                if (mv.move.row() >= rows || mv.move.col() >= cols) return false;
+                if (!board_.isEmpty(mv.move.row(), mv.move.col())) return false;
+                return true;
+            };
+            MoveEvaluation chosen = isUsableMove(bestSoFar) ? bestSoFar : eval;
+            if (!isUsableMove(chosen)) {
+                break;
+            }
+
+            MoveStatus st = applyMove(chosen.move.row(), chosen.move.col());
+            if (st != MoveStatus::Ok) {
+                break;
+            }
+            if (!positionDumpPath_.empty() && !gameOver_ && TuningPosition::isQuiet(board_)) {
+                dumped.push_back(TuningPosition::fromBoard(board_, mode_, creditedLinesX_, creditedLinesO_));
+            }
+
+            AIVsAIMoveInfo info;
+            info.isSwap   = false;
+            info.seat      = chooser;
+            info.phase     = OpeningPhase::Normal;
+            info.action.clear();
+            info.player    = sideToMove;
+            info.move      = chosen.move;
+            info.evalScore = chosen.score;
+            info.stats     = stats;
+            result.moves.push_back(info);
+
+            if (csv.is_open()) {
+                csv << moveIndex << ","
+                    << (sideToMove == Player::X ? "X" : "O") << ","
+                    << chosen.move.row() << "," << chosen.move.col() << ","
+                    << chosen.score << ","
+                    << stats.nodesVisited << ","
+                    << stats.nodesGenerated << ","
+                    << stats.cacheHits << ","
+                    << stats.cacheMisses << ","
+                    << stats.timeMs << "\n";
+            }
+
+            
+            std::function<void(const Board&, Player, const MoveEvaluation&, const AIStatistics&)> cb;
+            {
+                std::lock_guard<std::mutex> lk(cbMutex_);
+                cb = onAIMoveCallback_;
+            }
+            if (cb) {
+                cb(board_, sideToMove, chosen, stats);
+            }
+        }
+
+        
+        if (mode_ == GameMode::LinesScore) {
+            result.finalLinesX = creditedLinesX_;
+            result.finalLinesO = creditedLinesO_;
+            result.finalScore  = score();
+
+            if (result.finalScore > 0) {
+                result.oWins = true;
+            } else if (result.finalScore < 0) {
+                result.xWins = true;
+            } else {
+                result.draw = true;
+            }
+        } else { 
+            bool xWin = board_.checkWin(CellState::X);
+            bool oWin = board_.checkWin(CellState::O);
+            result.finalLinesX = countLinesFor(board_, CellState::X);
+            result.finalLinesO = countLinesFor(board_, CellState::O);
+            result.finalScore  = result.finalLinesO - result.finalLinesX;
+
+            result.xWins = xWin && !oWin;
+            result.oWins = oWin && !xWin;
+            result.draw  = !xWin && !oWin;
+        }
+
+        if (csv.is_open()) {
+            csv.close();
+        }
+        bool cancelled = cancelFlag && cancelFlag->load(std::memory_order_relaxed);
+        if (!dumped.empty() && gameOver_ && !cancelled) {
+            std::ofstream dump(positionDumpPath_, std::ios::app);
+            double outcome = result.xWins ? 1.0 : (result.oWins ? 0.0 : 0.5);
+            for (size_t i = 0; i < dumped.size(); ++i) {
+                dumped[i].result = outcome;
+                dump << dumped[i].format() << "\n";
+            }
+        }
+        return result;
+    }
+
+    
+    inline bool stepAIVsAIMove(int depthX, bool memoX, int depthO, bool memoO, AIVsAIMoveInfo& outMove, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMsX = -1, int timeLimitMsO = -1)
+    {
+        if (gameOver_) {
+            return false;
+        }
+
+        Seat chooser = seatToMove_;
+        Player sideToMove = currentPlayer_;
+        int  depth = (chooser == Seat::A) ? depthX : depthO;
+        bool memo  = (chooser == Seat::A) ? memoX : memoO;
+
+        
+        if (openingPhase_ != OpeningPhase::Normal) {
+            Player chooserSide = sideOf(chooser);
+            if (autoResolveOpeningChoiceForCurrentAI(depth, memo, cancelFlag)) {
+                outMove.isSwap   = true;
+                outMove.seat     = lastOpeningChoiceSeat_;
+                outMove.phase    = lastOpeningChoicePhase_;
+                outMove.action   = lastOpeningChoiceAction_;
+                outMove.player   = chooserSide;
+                outMove.move     = Coord(-1, -1);
+                outMove.evalScore = 0;
+                outMove.stats    = AIStatistics();
+                return true;
+            }
+        }
+
+        AIStatistics stats;
+        int timeLimit = (chooser == Seat::A) ? timeLimitMsX : timeLimitMsO;
+        MoveEvaluation bestSoFar(Coord(-1, -1), std::numeric_limits<int>::min());
+        MoveEvaluation eval = findBestMoveForSeat(chooser, sideToMove, depth, memo, stats, &bestSoFar, cancelFlag, timeLimit);
+
+        auto isUsableMove = [&](const MoveEvaluation& mv) {
+            if (mv.move.row() < 0 || mv.move.col() < 0) return false;
+            int rows = board_.getRows();
+            int cols = board_.getCols();
+            if (mv.move.row() >= rows || mv.move.col() >= cols) return false;
+            if (!board_.isEmpty(mv.move.row(), mv.move.col())) return false;
+            return true;
+        };
+        MoveEvaluation chosen = isUsableMove(bestSoFar) ? bestSoFar : eval;
+        if (!isUsableMove(chosen)) {
+            return false;
+        }
+
+        MoveStatus st = applyMove(chosen.move.row(), chosen.move.col());
+        if (st != MoveStatus::Ok) {
+            return false;
+        }
+
+        outMove.isSwap    = false;
+        outMove.action.clear();
+        outMove.player    = sideToMove;
+        outMove.seat      = chooser;
+        outMove.phase     = OpeningPhase::Normal;
+        outMove.move      = chosen.move;
+        outMove.evalScore = chosen.score;
+        outMove.stats     = stats;
+
+        if (ponderEnabled_) {
+            startPondering(chooser, depth, memo, timeLimit);
+        }
+        return true;
     }
 
-    
-    MoveEvaluation findBestMoveForSeat(Seat seat, Player sideToMove, int depth, bool useMemoization, AIStatistics& outStats, MoveEvaluation* bestSoFar = nullptr, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMs = -1)
+private:
+    MoveEvaluation searchForSeat(Seat seat, Player sideToMove, int depth, bool useMemoization, AIStatistics& outStats, MoveEvaluation* bestSoFar, std::atomic<bool>* cancelFlag, int timeLimitMs)
     {
         Player seatSide = sideOf(seat);
 
@@ -1004,10 +1540,19 @@ public:
             params.setUseMemoization(useMemoization);
             params.setMoveGenMode(moveGenMode_);
             params.setUseLMR(useLMR_);
+            params.setUseNullMove(useNullMove_);
+            params.setUseProbCut(useProbCut_);
+            params.setEvalBackend(evalBackend_);
+            params.setNeuralNet(neuralNet());
+            params.setEvalWeights(evalWeights());
+            params.setSearchEngine(searchEngine_);
             params.setUseExtensions(useExtensions_);
             params.setPerfectClassic3(perfectClassic3_);
             params.setBanCenterFirstMove(openingRule_ == OpeningRule::None);
             params.setTimeLimitMs(timeLimitMs);
+            params.setThreadBudget(threadBudget_);
+            params.setGameClock(clockForSeat(seat), timeIncrementMs_);
+            params.setDeterministic(deterministic_);
             AnalysisResult res = analysePosition(board_, sideToMove, mode_, params,
                                                  creditedLinesX_, creditedLinesO_,
                                                  cancelFlag);
@@ -1035,6 +1580,11 @@ public:
             return bestEval;
         }
 
+        MoveEvaluation ponderEval;
+        if (takePonderResult(seat, sideToMove, outStats, bestSoFar, cancelFlag, ponderEval)) {
+            return ponderEval;
+        }
+
         MinimaxAI& ai = aiForSeat(seat);
         ai.setPlayer(sideToMove);
         ai.setMaxDepth(depth);
@@ -1043,8 +1593,15 @@ public:
         ai.setBestSoFar(bestSoFar);
         ai.setCredits(creditedLinesX_, creditedLinesO_);
         ai.setTimeLimitMs(timeLimitMs);
+        ai.setGameClock(clockForSeat(seat), timeIncrementMs_);
         ai.setMoveGenMode(moveGenMode_);
         ai.setUseLMR(useLMR_);
+        ai.setUseNullMove(useNullMove_);
+        ai.setUseProbCut(useProbCut_);
+        ai.setEvalBackend(evalBackend_);
+        ai.setNeuralNet(neuralNet());
+        ai.setEvalWeights(evalWeights());
+        ai.setSearchEngine(searchEngine_);
         ai.setUseExtensions(useExtensions_);
         ai.setPerfectClassic3(perfectClassic3_);
         ai.setBanCenterFirstMove(openingRule_ == OpeningRule::None);
@@ -1064,219 +1621,30 @@ public:
         return eval;
     }
 
-    MoveEvaluation findBestMove(Player aiPlayer, int depth, bool useMemoization, AIStatistics& outStats, MoveEvaluation* bestSoFar = nullptr, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMs = -1)
-    {
-        return findBestMoveForSeat(seatOf(aiPlayer), aiPlayer, depth, useMemoization, outStats, bestSoFar, cancelFlag, timeLimitMs);
+    void applyDeterminism(MinimaxAI& ai) {
+        ai.setDeterministic(deterministic_);
+        ai.setIterationNodeBudget(iterationNodeBudget_);
     }
 
-    
-    AIVsAIResult runAIVsAIGame(int depthX, bool memoX, int depthO, bool memoO, const std::string& csvFilename, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMsX = -1, int timeLimitMsO = -1)
-    {
-        int rows   = board_.getRows();
-        int cols   = board_.getCols();
-        int winLen = board_.getWinLength();
-        newGame(rows, cols, winLen, mode_, openingRule_);
-
-        AIVsAIResult result{};
-        result.mode = mode_;
-        result.finalLinesX = 0;
-        result.finalLinesO = 0;
-        result.finalScore = 0;
-        result.xWins = false;
-        result.oWins = false;
-        result.draw = false;
-        result.moves.clear();
-
-        std::ofstream csv(csvFilename);
-        if (csv.is_open()) {
-            csv << "Move,Player,Row,Col,EvalScore,"
-                   "NodesVisited,NodesGenerated,CacheHits,CacheMisses,TimeMs\n";
-        }
-
-        int moveIndex = 0;
-
-        while (!gameOver_) {
-            if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) {
-                break;
-            }
-            ++moveIndex;
-            Seat chooser = seatToMove_;
-            Player sideToMove = currentPlayer_;
-            int  depth = (chooser == Seat::A) ? depthX : depthO;
-            bool memo  = (chooser == Seat::A) ? memoX : memoO;
-
-        if (openingPhase_ != OpeningPhase::Normal) {
-            Player chooserSide = sideOf(chooser);
-                if (autoResolveOpeningChoiceForCurrentAI(depth, memo, cancelFlag)) {
-                    AIVsAIMoveInfo info;
-                    info.isSwap   = true;
-                    info.seat     = lastOpeningChoiceSeat_;
-                    info.phase    = lastOpeningChoicePhase_;
-                    info.action   = lastOpeningChoiceAction_;
-                    info.player   = chooserSide;
-                    info.move     = Coord(-1, -1);
-                    info.evalScore = 0;
-                    info.stats    = AIStatistics();
-                result.moves.push_back(info);
-                    if (csv.is_open()) {
-                        csv << moveIndex << ",CHOICE,,,,,,,,\n";
-                    }
-                    continue;
-                }
-            }
-
-            AIStatistics stats;
-            int timeLimit = (chooser == Seat::A) ? timeLimitMsX : timeLimitMsO;
-            MoveEvaluation bestSoFar(Coord(-1, -1), std::numeric_limits<int>::min());
-            MoveEvaluation eval = findBestMoveForSeat(chooser, sideToMove, depth, memo, stats, &bestSoFar, cancelFlag, timeLimit);
-
-            auto isUsableMove = [&](const MoveEvaluation& mv) {
-                if (mv.move.row() < 0 || mv.move.col() < 0) return false;
-                int rows = board_.getRows();
-                int cols = board_.getCols();
-                if (mv.move.row() >= rows || mv.move.col() >= cols) return false;
-                if (!board_.isEmpty(mv.move.row(), mv.move.col())) return false;
-                return true;
-            };
-            MoveEvaluation chosen = isUsableMove(bestSoFar) ? bestSoFar : eval;
-            if (!isUsableMove(chosen)) {
-                break;
-            }
-
-            MoveStatus st = applyMove(chosen.move.row(), chosen.move.col());
-            if (st != MoveStatus::Ok) {
-                break;
-            }
-
-            AIVsAIMoveInfo info;
-            info.isSwap   = false;
-            info.seat      = chooser;
-            info.phase     = OpeningPhase::Normal;
-            info.action.clear();
-            info.player    = sideToMove;
-            info.move      = chosen.move;
-            info.evalScore = chosen.score;
-            info.stats     = stats;
-            result.moves.push_back(info);
-
-            if (csv.is_open()) {
-                csv << moveIndex << ","
-                    << (sideToMove == Player::X ? "X" : "O") << ","
-                    << chosen.move.row() << "," << chosen.move.col() << ","
-                    << chosen.score << ","
-                    << stats.nodesVisited << ","
-                    << stats.nodesGenerated << ","
-                    << stats.cacheHits << ","
-                    << stats.cacheMisses << ","
-                    << stats.timeMs << "\n";
-            }
-
-            
-            std::function<void(const Board&, Player, const MoveEvaluation&, const AIStatistics&)> cb;
-            {
-                std::lock_guard<std::mutex> lk(cbMutex_);
-                cb = onAIMoveCallback_;
-            }
-            if (cb) {
-                cb(board_, sideToMove, chosen, stats);
-            }
-        }
-
-        
-        if (mode_ == GameMode::LinesScore) {
-            result.finalLinesX = creditedLinesX_;
-            result.finalLinesO = creditedLinesO_;
-            result.finalScore  = score();
-
-            if (result.finalScore > 0) {
-                result.oWins = true;
-            } else if (result.finalScore < 0) {
-                result.xWins = true;
-            } else {
-                result.draw = true;
-            }
-        } else { 
-            bool xWin = board_.checkWin(CellState::X);
-            bool oWin = board_.checkWin(CellState::O);
-            result.finalLinesX = countLinesFor(board_, CellState::X);
-            result.finalLinesO = countLinesFor(board_, CellState::O);
-            result.finalScore  = result.finalLinesO - result.finalLinesX;
-
-            result.xWins = xWin && !oWin;
-            result.oWins = oWin && !xWin;
-            result.draw  = !xWin && !oWin;
-        }
-
-        if (csv.is_open()) {
-            csv.close();
-        }
-        return result;
+    void resetClocks() {
+        seatClockMs_[0] = timeControlMs_;
+        seatClockMs_[1] = timeControlMs_;
     }
 
-    
-    inline bool stepAIVsAIMove(int depthX, bool memoX, int depthO, bool memoO, AIVsAIMoveInfo& outMove, std::atomic<bool>* cancelFlag = nullptr, int timeLimitMsX = -1, int timeLimitMsO = -1)
-    {
-        if (gameOver_) {
-            return false;
-        }
-
-        Seat chooser = seatToMove_;
-        Player sideToMove = currentPlayer_;
-        int  depth = (chooser == Seat::A) ? depthX : depthO;
-        bool memo  = (chooser == Seat::A) ? memoX : memoO;
-
-        
-        if (openingPhase_ != OpeningPhase::Normal) {
-            Player chooserSide = sideOf(chooser);
-            if (autoResolveOpeningChoiceForCurrentAI(depth, memo, cancelFlag)) {
-                outMove.isSwap   = true;
-                outMove.seat     = lastOpeningChoiceSeat_;
-                outMove.phase    = lastOpeningChoicePhase_;
-                outMove.action   = lastOpeningChoiceAction_;
-                outMove.player   = chooserSide;
-                outMove.move     = Coord(-1, -1);
-                outMove.evalScore = 0;
-                outMove.stats    = AIStatistics();
-                return true;
-            }
-        }
-
-        AIStatistics stats;
-        int timeLimit = (chooser == Seat::A) ? timeLimitMsX : timeLimitMsO;
-        MoveEvaluation bestSoFar(Coord(-1, -1), std::numeric_limits<int>::min());
-        MoveEvaluation eval = findBestMoveForSeat(chooser, sideToMove, depth, memo, stats, &bestSoFar, cancelFlag, timeLimit);
-
-        auto isUsableMove = [&](const MoveEvaluation& mv) {
-            if (mv.move.row() < 0 || mv.move.col() < 0) return false;
-            int rows = board_.getRows();
-            int cols = board_.getCols();
-            if (mv.move.row() >= rows || mv.move.col() >= cols) return false;
-            if (!board_.isEmpty(mv.move.row(), mv.move.col())) return false;
-            return true;
-        };
-        MoveEvaluation chosen = isUsableMove(bestSoFar) ? bestSoFar : eval;
-        if (!isUsableMove(chosen)) {
-            return false;
-        }
-
-        MoveStatus st = applyMove(chosen.move.row(), chosen.move.col());
-        if (st != MoveStatus::Ok) {
-            return false;
-        }
-
-        outMove.isSwap    = false;
-        outMove.action.clear();
-        outMove.player    = sideToMove;
-        outMove.seat      = chooser;
-        outMove.phase     = OpeningPhase::Normal;
-        outMove.move      = chosen.move;
-        outMove.evalScore = chosen.score;
-        outMove.stats     = stats;
+    // The AI only sees a positive remainder: a flagged clock still leaves it the minimal budget.
+    int clockForSeat(Seat seat) const {
+        if (timeControlMs_ <= 0) return -1;
+        return std::max(1, seatClockMs_[seat == Seat::A ? 0 : 1]);
+    }
 
-        return true;
+    void chargeClock(Seat seat, long long spentMs) {
+        std::lock_guard<std::recursive_mutex> lk(stateMutex_);
+        if (timeControlMs_ <= 0) return;
+        int& clock = seatClockMs_[seat == Seat::A ? 0 : 1];
+        long long left = static_cast<long long>(clock) - spentMs + timeIncrementMs_;
+        clock = static_cast<int>(std::max(0LL, left));
     }
 
-private:
     Board board_;
     GameMode mode_;
     Player currentPlayer_;
@@ -1300,8 +1668,29 @@ private:
     EnginePreset enginePreset_ = EnginePreset::Fast;
     MoveGenMode moveGenMode_ = MoveGenMode::Hybrid;
     bool useLMR_ = true;
+    bool useNullMove_ = false;
+    bool useProbCut_ = false;
+    EvalBackend evalBackend_ = EvalBackend::Windows;
+    SearchEngine searchEngine_ = SearchEngine::AlphaBeta;
+    NeuralNet evalNet_;
+
+    EvalWeightSet windowWeights_;
+    std::string positionDumpPath_;
+    int randomOpeningPlies_ = 0;
+    std::mt19937 openingRng_;
+
+    const NeuralNet* neuralNet() const { return evalNet_.ready() ? &evalNet_ : nullptr; }
+    const EvalWeightSet* evalWeights() const { return windowWeights_.empty() ? nullptr : &windowWeights_; }
     bool useExtensions_ = true;
     bool perfectClassic3_ = false;
+    int threadBudget_ = 0;
+    bool deterministic_ = false;
+    uint64_t iterationNodeBudget_ = 0;
+    bool earlyFinish_ = false;
+    bool finishedEarly_ = false;
+    int timeControlMs_ = -1;
+    int timeIncrementMs_ = 0;
+    int seatClockMs_[2] = { -1, -1 };
     static constexpr int OPENING_ANALYSIS_LIMIT_MS = 120;
     static constexpr int OPENING_TOTAL_LIMIT_MS = 1000;
     mutable int openingTimeLimitMs_ = -1;
@@ -1310,6 +1699,28 @@ private:
     MinimaxAI aiA_;
     MinimaxAI aiB_;
 
+    class PonderState {
+    public:
+        bool active = false;
+        Seat seat = Seat::A;
+        Player side = Player::X;
+        Coord expectedReply = Coord(-1, -1);
+        Board board;
+        int scoreX = 0;
+        int scoreO = 0;
+        MoveEvaluation result;
+        MoveEvaluation bestSoFar;
+        AIStatistics stats;
+        std::atomic<bool> cancel{false};
+        std::atomic<bool> done{false};
+    };
+
+    bool ponderEnabled_ = false;
+    PonderState ponder_;
+    std::thread ponderThread_;
+    int ponderHits_ = 0;
+    int ponderMisses_ = 0;
+
     std::function<void(const Board&, Player, const MoveEvaluation&, const AIStatistics&)> onAIMoveCallback_;
     mutable std::mutex cbMutex_;
     mutable std::recursive_mutex stateMutex_;
@@ -1405,16 +1816,39 @@ private:
         }
     }
 
+    void playRandomOpening(int plies) {
+        int rows = board_.getRows();
+        int cols = board_.getCols();
+        int r0 = std::max(0, rows / 2 - 2);
+        int c0 = std::max(0, cols / 2 - 2);
+        int r1 = std::min(rows - 1, rows / 2 + 2);
+        int c1 = std::min(cols - 1, cols / 2 + 2);
+        int attempts = 0;
+        for (int placed = 0; placed < plies && !gameOver_ && attempts < 100; ++attempts) {
+            int r = r0 + static_cast<int>(openingRng_() % static_cast<unsigned>(r1 - r0 + 1));
+            int c = c0 + static_cast<int>(openingRng_() % static_cast<unsigned>(c1 - c0 + 1));
+            if (!board_.isEmpty(r, c)) continue;
+            if (applyMove(r, c) == MoveStatus::Ok) ++placed;
+        }
+    }
+
     SearchParams makeOpeningParams(int depthHint, bool memoHint) const {
         SearchParams params;
         params.setMaxDepth(std::max(1, std::min(depthHint, 4)));
         params.setUseMemoization(memoHint);
         params.setMoveGenMode(moveGenMode_);
         params.setUseLMR(useLMR_);
+        params.setUseNullMove(useNullMove_);
+        params.setUseProbCut(useProbCut_);
+        params.setEvalBackend(evalBackend_);
+        params.setNeuralNet(neuralNet());
+        params.setEvalWeights(evalWeights());
+        params.setSearchEngine(searchEngine_);
         params.setUseExtensions(useExtensions_);
         params.setPerfectClassic3(perfectClassic3_);
         params.setBanCenterFirstMove(openingRule_ == OpeningRule::None);
         params.setTimeLimitMs(OPENING_ANALYSIS_LIMIT_MS);
+        params.setThreadBudget(threadBudget_);
         return params;
     }
 
@@ -1514,6 +1948,59 @@ private:
         return moves;
     }
 
+    bool sameBoard(const Board& a, const Board& b) const {
+        if (a.getRows() != b.getRows() || a.getCols() != b.getCols() ||
+            a.getWinLength() != b.getWinLength()) {
+            return false;
+        }
+        for (int row = 0; row < a.getRows(); ++row) {
+            for (int col = 0; col < a.getCols(); ++col) {
+                if (a.getNoCheck(row, col) != b.getNoCheck(row, col)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool takePonderResult(Seat seat, Player sideToMove, AIStatistics& outStats,
+                          MoveEvaluation* bestSoFar, std::atomic<bool>* cancelFlag,
+                          MoveEvaluation& out)
+    {
+        std::unique_lock<std::recursive_mutex> lk(stateMutex_);
+        if (!ponder_.active || ponder_.seat != seat) return false;
+        bool hit = ponder_.side == sideToMove &&
+                   ponder_.scoreX == creditedLinesX_ &&
+                   ponder_.scoreO == creditedLinesO_ &&
+                   sameBoard(ponder_.board, board_);
+        if (!hit) {
+            ++ponderMisses_;
+            stopPondering();
+            return false;
+        }
+
+        lk.unlock();
+        while (!ponder_.done.load(std::memory_order_acquire)) {
+            if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) {
+                ponder_.cancel.store(true, std::memory_order_relaxed);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        lk.lock();
+        if (ponderThread_.joinable()) {
+            ponderThread_.join();
+        }
+        ++ponderHits_;
+        MinimaxAI& ai = aiForSeat(seat);
+        ai.setCancelFlag(nullptr);
+        ai.setBestSoFar(nullptr);
+        ponder_.active = false;
+        outStats = ponder_.stats;
+        if (bestSoFar) {
+            *bestSoFar = ponder_.bestSoFar;
+        }
+        out = ponder_.result;
+        return true;
+    }
+
     void applyTempMove(Board& board, const Coord& mv, CellState stone, int& scoreX, int& scoreO) const {
         board.set(mv, stone);
         if (mode_ == GameMode::LinesScore) {
@@ -1734,6 +2221,23 @@ private:
         return best;
     }
 
+    bool linesOutcomeDecided() const {
+        int ownMoves = 2 * ((board_.emptyCount() + 1) / 2);
+        int maxX = std::min(board_.liveWindowCount(CellState::X), ownMoves);
+        int maxO = std::min(board_.liveWindowCount(CellState::O), ownMoves);
+        int diff = creditedLinesO_ - creditedLinesX_;
+        if (maxX == 0 && maxO == 0) return true;
+        return diff - maxX > 0 || diff + maxO < 0;
+    }
+
+    // `lastStone` has just moved, so its side gets the smaller half of the empty cells.
+    bool classicDeadDraw(CellState lastStone) const {
+        int empty = board_.emptyCount();
+        CellState next = (lastStone == CellState::X) ? CellState::O : CellState::X;
+        return board_.liveWindowCount(lastStone, empty / 2) == 0 &&
+               board_.liveWindowCount(next, (empty + 1) / 2) == 0;
+    }
+
     MoveStatus placeStoneForced(CellState stone, int row, int col) {
         if (gameOver_) return MoveStatus::GameAlreadyOver;
 
@@ -1759,10 +2263,16 @@ private:
             }
             if (board_.isFull()) {
                 gameOver_ = true;
+            } else if (earlyFinish_ && linesOutcomeDecided()) {
+                gameOver_ = true;
+                finishedEarly_ = true;
             }
         } else {
             if (board_.checkWin(stone) || board_.isFull()) {
                 gameOver_ = true;
+            } else if (earlyFinish_ && classicDeadDraw(stone)) {
+                gameOver_ = true;
+                finishedEarly_ = true;
             }
         }
         return MoveStatus::Ok;
@@ -0,0 +1,261 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Exact LinesScore endgame: with at most MAX_EMPTY empty cells the remaining
+// game is searched full-width. Positions are a pair of bitmasks over the empty
+// cells, so table keys are exact and every line is a mask test.
+class LinesEndgameSolver {
+public:
+    static constexpr int MAX_EMPTY = 24;
+    static constexpr size_t DEFAULT_TABLE_SIZE = 1u << 19;
+    static constexpr uint64_t DEFAULT_NODE_BUDGET = 4000000;
+
+    LinesEndgameSolver(const Board& board, size_t tableSize = DEFAULT_TABLE_SIZE)
+        : cols_(board.getCols())
+    {
+        int rows = board.getRows();
+        int winLen = board.getWinLength();
+        int total = rows * board.getCols();
+        DynamicArray<int> slotOf;
+        slotOf.reserve(static_cast<size_t>(total));
+        for (int i = 0; i < total; ++i) {
+            if (board.getNoCheck(i / cols_, i % cols_) == CellState::Empty && emptyCount_ < MAX_EMPTY) {
+                slotOf.push_back(emptyCount_);
+                cells_.push_back(i);
+                ++emptyCount_;
+            } else {
+                slotOf.push_back(-1);
+            }
+        }
+        if (board.emptyCount() > MAX_EMPTY) {
+            emptyCount_ = -1;
+            return;
+        }
+        for (int i = 0; i < emptyCount_; ++i) cellLines_.push_back(DynamicArray<int>());
+
+        const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+        for (int d = 0; d < 4; ++d) {
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols_; ++c) {
+                    int er = r + (winLen - 1) * dirs[d][0];
+                    int ec = c + (winLen - 1) * dirs[d][1];
+                    if (er < 0 || er >= rows || ec < 0 || ec >= cols_) continue;
+                    Line line;
+                    bool hasX = false;
+                    bool hasO = false;
+                    for (int k = 0; k < winLen; ++k) {
+                        int rr = r + k * dirs[d][0];
+                        int cc = c + k * dirs[d][1];
+                        CellState s = board.getNoCheck(rr, cc);
+                        if (s == CellState::X) hasX = true;
+                        else if (s == CellState::O) hasO = true;
+                        else line.need |= 1u << slotOf[rr * cols_ + cc];
+                    }
+                    if (line.need == 0 || (hasX && hasO)) continue;
+                    line.live[0] = !hasO;
+                    line.live[1] = !hasX;
+                    int idx = static_cast<int>(lines_.size());
+                    lines_.push_back(line);
+                    for (int s = 0; s < emptyCount_; ++s) {
+                        if (line.need & (1u << s)) cellLines_[s].push_back(idx);
+                    }
+                }
+            }
+        }
+
+        size_t size = 2;
+        while (size * 2 <= tableSize) size *= 2;
+        table_.reserve(size);
+        for (size_t i = 0; i < size; ++i) table_.push_back(Entry());
+        tableMask_ = size - 1;
+    }
+
+    bool applicable() const { return emptyCount_ > 0; }
+    void setNodeBudget(uint64_t nodes) { nodeBudget_ = nodes; }
+    void setCancelFlag(std::atomic<bool>* flag) { cancelFlag_ = flag; }
+    void setDeadline(std::chrono::steady_clock::time_point deadline) {
+        deadline_ = deadline;
+        hasDeadline_ = true;
+    }
+    uint64_t nodes() const { return nodes_; }
+
+    // Exact line differential still to be earned by the side to move (its credits
+    // minus the opponent's) under perfect play. Returns false when interrupted.
+    bool solve(CellState toMove, int& futureDiff, Coord& bestMove) {
+        bestMove = Coord(-1, -1);
+        futureDiff = 0;
+        if (!applicable()) return false;
+        aborted_ = false;
+        int side = (toMove == CellState::X) ? 0 : 1;
+        int bestSlot = -1;
+        int value = search(0, 0, side, -INF_SCORE, INF_SCORE, &bestSlot);
+        if (aborted_ || bestSlot < 0) return false;
+        futureDiff = value;
+        bestMove = Coord(cells_[bestSlot] / cols_, cells_[bestSlot] % cols_);
+        return true;
+    }
+
+private:
+    static constexpr int INF_SCORE = 1 << 20;
+
+    class Line {
+    public:
+        uint32_t need = 0;
+        bool live[2] = { false, false };
+    };
+
+    class Entry {
+    public:
+        uint64_t key = 0;
+        int16_t value = 0;
+        int8_t bestSlot = -1;
+        uint8_t flag = EMPTY_FLAG;
+    };
+
+    static constexpr uint8_t EMPTY_FLAG = 0;
+    static constexpr uint8_t EXACT = 1;
+    static constexpr uint8_t LOWER = 2;
+    static constexpr uint8_t UPPER = 3;
+
+    int cols_;
+    int emptyCount_ = 0;
+    DynamicArray<int> cells_;
+    DynamicArray<Line> lines_;
+    DynamicArray<DynamicArray<int>> cellLines_;
+    DynamicArray<Entry> table_;
+    size_t tableMask_ = 0;
+    uint64_t nodes_ = 0;
+    uint64_t nodeBudget_ = DEFAULT_NODE_BUDGET;
+    bool aborted_ = false;
+    std::atomic<bool>* cancelFlag_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_{};
+    bool hasDeadline_ = false;
+
+    static int popcount(uint32_t v) {
+        int n = 0;
+        while (v) {
+            v &= v - 1;
+            ++n;
+        }
+        return n;
+    }
+
+    bool outOfBudget() {
+        if (aborted_) return true;
+        if (nodeBudget_ > 0 && nodes_ >= nodeBudget_) aborted_ = true;
+        else if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) aborted_ = true;
+        else if (hasDeadline_ && (nodes_ & 4095) == 0 && std::chrono::steady_clock::now() >= deadline_) aborted_ = true;
+        return aborted_;
+    }
+
+    // Credits for `side` playing `slot`, plus an ordering hint from its open lines.
+    int credit(int slot, int side, uint32_t own, int& potential) const {
+        uint32_t after = own | (1u << slot);
+        int gained = 0;
+        potential = 0;
+        const DynamicArray<int>& wins = cellLines_[slot];
+        for (size_t i = 0; i < wins.size(); ++i) {
+            const Line& line = lines_[wins[i]];
+            if (!line.live[side]) continue;
+            uint32_t need = line.need;
+            if ((after & need) == need) {
+                ++gained;
+            } else {
+                potential += 1 << (2 * popcount(after & need));
+            }
+        }
+        return std::min(2, gained);
+    }
+
+    int search(uint32_t x, uint32_t o, int side, int alpha, int beta, int* rootBest) {
+        ++nodes_;
+        if (outOfBudget()) return 0;
+        uint32_t full = (emptyCount_ >= 32) ? 0xffffffffu : ((1u << emptyCount_) - 1);
+        uint32_t freeMask = full & ~(x | o);
+        if (freeMask == 0) return 0;
+
+        uint64_t key = static_cast<uint64_t>(x) | (static_cast<uint64_t>(o) << MAX_EMPTY) |
+                       (static_cast<uint64_t>(side) << (2 * MAX_EMPTY));
+        Entry& e = table_[static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 20) & tableMask_];
+        int ttSlot = -1;
+        if (e.flag != EMPTY_FLAG && e.key == key) {
+            ttSlot = e.bestSlot;
+            if (!rootBest) {
+                if (e.flag == EXACT) return e.value;
+                if (e.flag == LOWER && e.value >= beta) return e.value;
+                if (e.flag == UPPER && e.value <= alpha) return e.value;
+            }
+        }
+
+        int slots[MAX_EMPTY];
+        int gains[MAX_EMPTY];
+        int order[MAX_EMPTY];
+        int count = 0;
+        uint32_t own = (side == 0) ? x : o;
+        for (uint32_t m = freeMask; m; m &= m - 1) {
+            int slot = 0;
+            while (!((m >> slot) & 1u)) ++slot;
+            int potential = 0;
+            int g = credit(slot, side, own, potential);
+            slots[count] = slot;
+            gains[count] = g;
+            order[count] = (slot == ttSlot ? (1 << 28) : 0) + (g << 24) + potential;
+            ++count;
+        }
+        for (int i = 1; i < count; ++i) {
+            int s = slots[i];
+            int g = gains[i];
+            int o2 = order[i];
+            int j = i - 1;
+            while (j >= 0 && order[j] < o2) {
+                slots[j + 1] = slots[j];
+                gains[j + 1] = gains[j];
+                order[j + 1] = order[j];
+                --j;
+            }
+            slots[j + 1] = s;
+            gains[j + 1] = g;
+            order[j + 1] = o2;
+        }
+
+        int alphaOrig = alpha;
+        int best = -INF_SCORE;
+        int bestSlot = slots[0];
+        for (int i = 0; i < count; ++i) {
+            uint32_t bit = 1u << slots[i];
+            uint32_t nx = (side == 0) ? (x | bit) : x;
+            uint32_t no = (side == 1) ? (o | bit) : o;
+            int g = gains[i];
+            int val;
+            if (i == 0) {
+                val = g - search(nx, no, 1 - side, g - beta, g - alpha, nullptr);
+            } else {
+                val = g - search(nx, no, 1 - side, g - alpha - 1, g - alpha, nullptr);
+                if (val > alpha && val < beta && !aborted_) {
+                    val = g - search(nx, no, 1 - side, g - beta, g - alpha, nullptr);
+                }
+            }
+            if (aborted_) return 0;
+            if (val > best) {
+                best = val;
+                bestSlot = slots[i];
+            }
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) break;
+        }
+
+        e.key = key;
+        e.value = static_cast<int16_t>(best);
+        e.bestSlot = static_cast<int8_t>(bestSlot);
+        if (best <= alphaOrig) e.flag = UPPER;
+        else if (best >= beta) e.flag = LOWER;
+        else e.flag = EXACT;
+        if (rootBest) *rootBest = bestSlot;
+        return best;
+    }
+};
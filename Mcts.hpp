@@ -0,0 +1,270 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+// One node of the shared MCTS tree. Results are summed in points (WIN per won
+// visit) for the side that made the node's move; virtualLoss counts the
+// threads currently below the node, each seen by PUCT as a lost visit.
+// Children are contiguous in the pool and published by state = Expanded.
+class MctsNode {
+public:
+    enum : int { Leaf = 0, Expanding = 1, Expanded = 2 };
+    static constexpr int WIN = 1024;
+
+    std::atomic<int> visits{ 0 };
+    std::atomic<int64_t> points{ 0 };
+    std::atomic<int> virtualLoss{ 0 };
+    std::atomic<int> state{ Leaf };
+    int firstChild = -1;
+    int childCount = 0;
+    int cell = -1;
+    float prior = 0.0f;
+
+    double value() const {
+        int n = visits.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<double>(points.load(std::memory_order_relaxed)) / (static_cast<double>(WIN) * n) : 0.5;
+    }
+};
+
+// Fixed node pool; node 0 is the root. Once the pool is full leaves simply
+// stop expanding.
+class MctsTree {
+public:
+    static constexpr size_t MAX_NODES = size_t(1) << 20;
+
+    explicit MctsTree(size_t capacity)
+        : capacity_(std::max<size_t>(1, std::min(capacity, MAX_NODES))), nodes_(new MctsNode[capacity_]) {}
+
+    MctsNode& node(int idx) { return nodes_[static_cast<size_t>(idx)]; }
+    const MctsNode& node(int idx) const { return nodes_[static_cast<size_t>(idx)]; }
+    size_t used() const { return std::min(capacity_, next_.load(std::memory_order_relaxed)); }
+
+    // First of count fresh nodes, or -1 when they do not fit.
+    int allocate(int count) {
+        size_t first = next_.fetch_add(static_cast<size_t>(count), std::memory_order_relaxed);
+        if (first + static_cast<size_t>(count) > capacity_) return -1;
+        return static_cast<int>(first);
+    }
+
+    // PUCT: Q + cpuct * P * sqrt(N) / (1 + n), with virtual losses counted as visits.
+    // Unvisited children take the parent's value less fpuReduction.
+    int select(int parent, double cpuct, double fpuReduction) const {
+        const MctsNode& p = node(parent);
+        double parentVisits = p.visits.load(std::memory_order_relaxed) + p.virtualLoss.load(std::memory_order_relaxed);
+        double sqrtN = std::sqrt(std::max(1.0, parentVisits));
+        double fpu = std::max(0.0, 1.0 - p.value() - fpuReduction);
+        int best = p.firstChild;
+        double bestScore = -1.0;
+        for (int i = 0; i < p.childCount; ++i) {
+            const MctsNode& c = node(p.firstChild + i);
+            int n = c.visits.load(std::memory_order_relaxed);
+            int vl = c.virtualLoss.load(std::memory_order_relaxed);
+            double q = (n + vl > 0)
+                ? static_cast<double>(c.points.load(std::memory_order_relaxed)) / (static_cast<double>(MctsNode::WIN) * (n + vl))
+                : fpu;
+            double score = q + cpuct * c.prior * sqrtN / (1.0 + n + vl);
+            if (score > bestScore) {
+                bestScore = score;
+                best = p.firstChild + i;
+            }
+        }
+        return best;
+    }
+
+    // Most visited child, the higher value on a tie; -1 before the root is expanded.
+    int bestChild(int parent) const {
+        const MctsNode& p = node(parent);
+        if (p.state.load(std::memory_order_acquire) != MctsNode::Expanded) return -1;
+        int best = -1;
+        int bestVisits = -1;
+        double bestValue = -1.0;
+        for (int i = 0; i < p.childCount; ++i) {
+            const MctsNode& c = node(p.firstChild + i);
+            int n = c.visits.load(std::memory_order_relaxed);
+            double v = c.value();
+            if (n > bestVisits || (n == bestVisits && v > bestValue)) {
+                best = p.firstChild + i;
+                bestVisits = n;
+                bestValue = v;
+            }
+        }
+        return best;
+    }
+
+private:
+    size_t capacity_;
+    std::unique_ptr<MctsNode[]> nodes_;
+    std::atomic<size_t> next_{ 1 };
+};
+
+// Random playouts on bitboards (one bit per cell and side). A side completes
+// its own line when it can, otherwise blocks one of the opponent's, otherwise
+// plays a random empty cell next to a stone. Line cells are found from the
+// windows through each new stone, so a move costs O(winLen^2).
+class MctsPlayout {
+public:
+    MctsPlayout(int rows, int cols, int winLen, GameMode mode)
+        : rows_(rows), cols_(cols), winLen_(winLen), mode_(mode), total_(rows * cols)
+    {
+        size_t words = static_cast<size_t>((total_ + 63) / 64);
+        for (int side = 0; side < 2; ++side) {
+            for (size_t i = 0; i < words; ++i) bits_[side].push_back(0);
+        }
+        for (int i = 0; i < total_; ++i) nearMark_.push_back(0);
+    }
+
+    // Loads the position; lines already completable on it are added with addLineCell.
+    void load(const Board& board) {
+        for (int side = 0; side < 2; ++side) {
+            for (size_t i = 0; i < bits_[side].size(); ++i) bits_[side][i] = 0;
+            lineCells_[side].clear();
+        }
+        near_.clear();
+        if (++stamp_ == 0) {
+            for (int i = 0; i < total_; ++i) nearMark_[static_cast<size_t>(i)] = 0;
+            stamp_ = 1;
+        }
+        empty_ = total_;
+        for (int idx = 0; idx < total_; ++idx) {
+            CellState s = board.getNoCheck(idx / cols_, idx % cols_);
+            if (s == CellState::Empty) continue;
+            setBit(s == CellState::X ? 0 : 1, idx);
+            --empty_;
+        }
+        for (int idx = 0; idx < total_; ++idx) {
+            if (!isEmpty(idx)) addNeighbours(idx);
+        }
+    }
+
+    void addLineCell(CellState side, int idx) { lineCells_[side == CellState::X ? 0 : 1].push_back(idx); }
+
+    // Plays the position out with toMove to move and returns the outcome for X:
+    // Classic 1, 0 or -1, LinesScore the final credited lines of X minus O. moves
+    // counts the stones placed.
+    int run(CellState toMove, int scoreX, int scoreO, uint64_t& rng, uint64_t& moves) {
+        int side = (toMove == CellState::X) ? 0 : 1;
+        int credit[2] = { scoreX, scoreO };
+        while (empty_ > 0) {
+            int idx = takeLineCell(side);
+            if (idx < 0) idx = takeLineCell(1 - side);
+            if (idx < 0) idx = takeRandom(rng);
+            int gained = place(side, idx);
+            ++moves;
+            if (gained > 0) {
+                if (mode_ == GameMode::Classic) return side == 0 ? 1 : -1;
+                credit[side] += std::min(2, gained);
+            }
+            side = 1 - side;
+        }
+        return credit[0] - credit[1];
+    }
+
+    static uint64_t nextRandom(uint64_t& state) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dULL;
+    }
+
+private:
+    int rows_;
+    int cols_;
+    int winLen_;
+    GameMode mode_;
+    int total_;
+    int empty_ = 0;
+    DynamicArray<uint64_t> bits_[2];
+    DynamicArray<int> lineCells_[2];
+    DynamicArray<int> near_;
+    DynamicArray<uint32_t> nearMark_;
+    uint32_t stamp_ = 0;
+
+    bool has(int side, int idx) const {
+        return (bits_[side].unchecked(static_cast<size_t>(idx >> 6)) >> (idx & 63)) & 1;
+    }
+    bool isEmpty(int idx) const { return !has(0, idx) && !has(1, idx); }
+    void setBit(int side, int idx) { bits_[side].unchecked(static_cast<size_t>(idx >> 6)) |= uint64_t(1) << (idx & 63); }
+
+    int takeLineCell(int side) {
+        DynamicArray<int>& cells = lineCells_[side];
+        while (!cells.empty()) {
+            int idx = cells.unchecked(cells.size() - 1);
+            cells.pop_back();
+            if (isEmpty(idx)) return idx;
+        }
+        return -1;
+    }
+
+    int takeRandom(uint64_t& rng) {
+        while (!near_.empty()) {
+            size_t pick = static_cast<size_t>(nextRandom(rng) % near_.size());
+            int idx = near_[pick];
+            near_[pick] = near_.unchecked(near_.size() - 1);
+            near_.pop_back();
+            if (isEmpty(idx)) return idx;
+        }
+        int start = static_cast<int>(nextRandom(rng) % static_cast<uint64_t>(total_));
+        for (int k = 0; k < total_; ++k) {
+            int idx = (start + k) % total_;
+            if (isEmpty(idx)) return idx;
+        }
+        return -1;
+    }
+
+    void addNeighbours(int idx) {
+        int r = idx / cols_;
+        int c = idx % cols_;
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                int rr = r + dr;
+                int cc = c + dc;
+                if (rr < 0 || rr >= rows_ || cc < 0 || cc >= cols_) continue;
+                int n = rr * cols_ + cc;
+                if (nearMark_[static_cast<size_t>(n)] == stamp_ || !isEmpty(n)) continue;
+                nearMark_[static_cast<size_t>(n)] = stamp_;
+                near_.push_back(n);
+            }
+        }
+    }
+
+    // Sets the stone and returns the lines it completes; every window through it
+    // left one own stone short gets its empty cell recorded.
+    int place(int side, int idx) {
+        setBit(side, idx);
+        --empty_;
+        addNeighbours(idx);
+        static const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+        int r = idx / cols_;
+        int c = idx % cols_;
+        int gained = 0;
+        for (int d = 0; d < 4; ++d) {
+            int dr = dirs[d][0];
+            int dc = dirs[d][1];
+            for (int back = 0; back < winLen_; ++back) {
+                int sr = r - back * dr;
+                int sc = c - back * dc;
+                int er = sr + (winLen_ - 1) * dr;
+                int ec = sc + (winLen_ - 1) * dc;
+                if (sr < 0 || sr >= rows_ || sc < 0 || sc >= cols_ || er < 0 || er >= rows_ || ec < 0 || ec >= cols_) continue;
+                int own = 0;
+                int gap = -1;
+                bool blocked = false;
+                for (int k = 0; k < winLen_ && !blocked; ++k) {
+                    int cell = (sr + k * dr) * cols_ + sc + k * dc;
+                    if (has(side, cell)) ++own;
+                    else if (has(1 - side, cell)) blocked = true;
+                    else gap = cell;
+                }
+                if (blocked) continue;
+                if (own == winLen_) ++gained;
+                else if (own == winLen_ - 1) lineCells_[side].push_back(gap);
+            }
+        }
+        return gained;
+    }
+};
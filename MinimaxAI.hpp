@@ -3,6 +3,14 @@
 #include "Board.hpp"
 #include "HashMap.hpp"
 #include "DynamicArray.hpp"
+#include "CpuQuota.hpp"
+#include "TimeManager.hpp"
+#include "ThreatSearch.hpp"
+#include "ProofNumberSearch.hpp"
+#include "LinesEndgame.hpp"
+#include "NeuralEval.hpp"
+#include "EvalWeights.hpp"
+#include "Mcts.hpp"
 #include <limits>
 #include <chrono>
 #include <iostream>
@@ -31,6 +39,22 @@ enum class MoveGenMode {
     Hybrid
 };
 
+// Static evaluator: Windows scores every window by its stone counts; Patterns also
+// reads the window's two flank cells and the gaps between stones via lookup tables;
+// Neural runs a loaded NeuralNet and falls back to Windows when none matches the board.
+enum class EvalBackend {
+    Windows,
+    Patterns,
+    Neural
+};
+
+// Search driver: iterative-deepening alpha-beta, or Monte Carlo tree search (PUCT
+// over move-urgency priors, bitboard playouts, tree-parallel with virtual loss).
+enum class SearchEngine {
+    AlphaBeta,
+    Mcts
+};
+
 AnalysisResult analysePosition(const Board& b, Player toMove, GameMode mode, const SearchParams& params, int scoreX = 0, int scoreO = 0, std::atomic<bool>* cancelFlag = nullptr);
 
 class MoveEvaluation {
@@ -57,6 +81,36 @@ public:
     long long timeMs;      
     double elapsedMs;
     int completedDepth;    
+    uint64_t clockPolls;
+    long long stopLatencyMs;
+    bool nodeLimitHit;
+    uint64_t searchSignature;
+    uint64_t threatNodes;
+    bool threatWin;
+    uint64_t proofNodes;
+    ProofOutcome proofOutcome;
+    uint64_t endgameNodes;
+    bool endgameExact;
+    uint64_t boundCutoffs;
+    uint64_t deadDrawCutoffs;
+    uint64_t deadCellsPruned;
+    uint64_t forcedMoveNodes;
+    uint64_t quiescenceNodes;
+    uint64_t nullMoveTries;
+    uint64_t nullMoveCutoffs;
+    uint64_t probCutTries;
+    uint64_t probCutCutoffs;
+    uint64_t stagedCutoffs;
+    uint64_t orderCacheHits;
+    uint64_t orderCacheMisses;
+    uint64_t evalCacheHits;
+    uint64_t evalCacheMisses;
+    uint64_t mctsPlayouts;
+    uint64_t mctsTreeNodes;
+    uint64_t mtdfProbes;
+    // Indexed by remaining depth (1-3).
+    uint64_t futilityPruned[4];
+    uint64_t lateMovePruned[4];
 
     AIStatistics()
         : nodesVisited(0),
@@ -71,7 +125,36 @@ public:
         expandedMoves(0),
         timeMs(0),
         elapsedMs(0.0),
-        completedDepth(0) {}
+        completedDepth(0),
+        clockPolls(0),
+        stopLatencyMs(0),
+        nodeLimitHit(false),
+        searchSignature(0),
+        threatNodes(0),
+        threatWin(false),
+        proofNodes(0),
+        proofOutcome(ProofOutcome::Unknown),
+        endgameNodes(0),
+        endgameExact(false),
+        boundCutoffs(0),
+        deadDrawCutoffs(0),
+        deadCellsPruned(0),
+        forcedMoveNodes(0),
+        quiescenceNodes(0),
+        nullMoveTries(0),
+        nullMoveCutoffs(0),
+        probCutTries(0),
+        probCutCutoffs(0),
+        stagedCutoffs(0),
+        orderCacheHits(0),
+        orderCacheMisses(0),
+        evalCacheHits(0),
+        evalCacheMisses(0),
+        mctsPlayouts(0),
+        mctsTreeNodes(0),
+        mtdfProbes(0),
+        futilityPruned{},
+        lateMovePruned{} {}
 
     void reset() {
         nodesVisited = 0;
@@ -87,6 +170,37 @@ public:
         timeMs = 0;
         elapsedMs = 0.0;
         completedDepth = 0;
+        clockPolls = 0;
+        stopLatencyMs = 0;
+        nodeLimitHit = false;
+        searchSignature = 0;
+        threatNodes = 0;
+        threatWin = false;
+        proofNodes = 0;
+        proofOutcome = ProofOutcome::Unknown;
+        endgameNodes = 0;
+        endgameExact = false;
+        boundCutoffs = 0;
+        deadDrawCutoffs = 0;
+        deadCellsPruned = 0;
+        forcedMoveNodes = 0;
+        quiescenceNodes = 0;
+        nullMoveTries = 0;
+        nullMoveCutoffs = 0;
+        probCutTries = 0;
+        probCutCutoffs = 0;
+        stagedCutoffs = 0;
+        orderCacheHits = 0;
+        orderCacheMisses = 0;
+        evalCacheHits = 0;
+        evalCacheMisses = 0;
+        mctsPlayouts = 0;
+        mctsTreeNodes = 0;
+        mtdfProbes = 0;
+        for (int d = 0; d < 4; ++d) {
+            futilityPruned[d] = 0;
+            lateMovePruned[d] = 0;
+        }
     }
 
     void print() const {
@@ -118,16 +232,51 @@ private:
     GameMode mode_;            
     std::atomic<bool>* cancelFlag_ = nullptr;
     MoveEvaluation* bestSoFarPtr_ = nullptr;
-    DynamicArray<int>* historyTable_ = nullptr;
     int creditedX_ = 0;
     int creditedO_ = 0;
-    static constexpr int WIN_SCORE = 1000000000;
+    static constexpr int WIN_SCORE = EvalWeights::ENGINE_WIN_SCORE;
     static constexpr int MAX_KILLER_DEPTH = 64;
     Coord killerMoves_[MAX_KILLER_DEPTH][2]{};
+
+    // Ordering memory kept across searches, per side and indexed by cell: history
+    // scores (halved at every search), counter moves (reply to the opponent's last
+    // cell) and follow-ups (next own cell after an own cell). path_ holds the moves
+    // leading to the current node.
+    static constexpr int HISTORY_MAX = 1500;
+    static constexpr int COUNTER_MOVE_BONUS = 2000;
+    static constexpr int FOLLOW_UP_BONUS = 1500;
+    DynamicArray<int> history_[2];
+    DynamicArray<Coord> counterMoves_[2];
+    DynamicArray<Coord> followUps_[2];
+    int historyCols_ = 0;
+    DynamicArray<Coord> path_;
     DynamicArray<uint64_t> zobristTable_;
     uint64_t zobristPlayerX_ = 0;
     uint64_t zobristPlayerO_ = 0;
     int timeLimitMs_ = -1;
+    int hardLimitMs_ = -1;
+    int gameTimeMs_ = -1;
+    int incrementMs_ = 0;
+    TimeManager timeManager_;
+    static constexpr uint32_t DEFAULT_CLOCK_POLL_INTERVAL = 1024;
+    uint32_t clockPollInterval_ = DEFAULT_CLOCK_POLL_INTERVAL;
+    uint64_t nodeLimit_ = 0;
+    uint64_t activeNodeLimit_ = 0;
+    bool deterministic_ = false;
+    uint64_t iterationNodeBudget_ = 0;
+    bool useThreatSearch_ = true;
+    uint64_t threatNodeBudget_ = ThreatSearch::DEFAULT_NODE_BUDGET;
+    static constexpr int DEFAULT_PROOF_THRESHOLD = 16;
+    static constexpr uint64_t DEFAULT_PROOF_NODE_BUDGET = 300000;
+    int proofThreshold_ = DEFAULT_PROOF_THRESHOLD;
+    uint64_t proofNodeBudget_ = DEFAULT_PROOF_NODE_BUDGET;
+    static constexpr int DEFAULT_ENDGAME_THRESHOLD = 16;
+    int endgameThreshold_ = DEFAULT_ENDGAME_THRESHOLD;
+    uint64_t endgameNodeBudget_ = LinesEndgameSolver::DEFAULT_NODE_BUDGET;
+    mutable uint32_t pollCountdown_ = 0;
+    mutable uint64_t clockPolls_ = 0;
+    mutable bool stopped_ = false;
+    mutable long long stopReferenceMs_ = 0;
     std::chrono::steady_clock::time_point startTime_;
     class WindowInfo {
     public:
@@ -141,6 +290,52 @@ private:
     DynamicArray<WindowInfo> windows_;
     DynamicArray<DynamicArray<int>> cellWindows_;
     DynamicArray<int> windowWeight_;
+    // Windows with no opposing stone that are not yet complete, indexed X = 0, O = 1,
+    // in total and by the number of own stones already in them.
+    int liveWindows_[2] = { 0, 0 };
+    DynamicArray<int> liveByOwn_[2];
+    bool useLineBounds_ = true;
+    // Per cell: windows through it that do not yet hold both colours. A cell at 0 is
+    // dead: playing it can no longer make or block a line for either side.
+    DynamicArray<int> cellOpenWindows_;
+    bool dropDeadCells_ = true;
+    // Per cell and side (X = 0, O = 1), for an empty cell: lines completed by playing
+    // it, and the change of windowScoreSum_ it would cause. Kept for every window
+    // touched by applyMoveEval/undoMoveEval, so ordering needs no trial moves.
+    DynamicArray<int> cellGain_[2];
+    DynamicArray<int64_t> cellThreat_[2];
+    bool classicMustPlay_ = true;
+    static constexpr int DEFAULT_QUIESCENCE_PLY_CAP = 8;
+    static constexpr uint64_t DEFAULT_QUIESCENCE_NODE_CAP = 400000;
+    bool useQuiescence_ = true;
+    int quiescencePlyCap_ = DEFAULT_QUIESCENCE_PLY_CAP;
+    uint64_t quiescenceNodeCap_ = DEFAULT_QUIESCENCE_NODE_CAP;
+    static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+    static constexpr int PROBCUT_MIN_DEPTH = 5;
+    static constexpr int PROBCUT_REDUCTION = 4;
+    bool useNullMove_ = false;
+    bool useProbCut_ = false;
+    bool allowForwardPruning_ = true;
+    static constexpr int SHALLOW_PRUNE_DEPTH = 3;
+    bool useShallowPruning_ = true;
+    // Pattern backend: each window plus its flank cells (the board edge is a wall) is
+    // kept as a code with base-4 flanks and base-3 window cells; patternValue_ maps a
+    // code to the X-minus-O shape score and patternSum_ is its total over all windows.
+    static constexpr int PATTERN_MAX_WIN = 8;
+    EvalBackend evalBackend_ = EvalBackend::Windows;
+    bool patternActive_ = false;
+    int patternWinLen_ = 0;
+    GameMode patternMode_ = GameMode::Classic;
+    DynamicArray<int> patternValue_;
+    DynamicArray<int> patternCode_;
+    DynamicArray<DynamicArray<std::pair<int,int>>> cellPatterns_;
+    int64_t patternSum_ = 0;
+    const NeuralNet* neuralNet_ = nullptr;
+    bool neuralActive_ = false;
+    // Tuned window weights and cell bonuses; the built-in tables are used for any
+    // geometry the set does not cover.
+    const EvalWeightSet* evalWeights_ = nullptr;
+    DynamicArray<int16_t> neuralAcc_;
     DynamicArray<int> posValues_;
     int64_t windowScoreSum_ = 0;
     int64_t centerBias_ = 0;
@@ -156,6 +351,7 @@ private:
     bool perfectClassic3_ = false;
     bool banCenterFirstMove_ = false;
     bool allowOpeningShortcut_ = true;
+    int threadBudget_ = 0;
 
     class TTEntry {
     public:
@@ -168,7 +364,58 @@ private:
 
     
     HashMap<size_t, TTEntry> transpositionTable_;
+
+    // Ordered move list of a node from its last full visit, so the next iteration
+    // skips generation and static scoring; only the static urgency is kept, the
+    // TT/killer/history bonuses are re-applied on a hit. Direct-mapped and lossy;
+    // lists longer than ORDER_CACHE_MOVES are not kept. Entries age out with the TT generation.
+    static constexpr size_t ORDER_CACHE_SIZE = 1u << 12;
+    static constexpr int ORDER_CACHE_MOVES = 64;
+    static constexpr uint16_t ORDER_MUST_PLAY = 0x8000;
+
+    class OrderCacheEntry {
+    public:
+        uint64_t key = 0;
+        uint64_t generation = 0;
+        uint8_t count = 0;
+        uint8_t depthBucket = 0;
+        uint16_t cells[ORDER_CACHE_MOVES];
+        int baseUrgency[ORDER_CACHE_MOVES];
+    };
+
+    DynamicArray<OrderCacheEntry> orderCache_;
+    bool useOrderCache_ = true;
+
+    // Static evals of leaf positions, keyed like the TT (Zobrist plus credits).
+    // Direct-mapped, always replace; the eval is a pure function of the key.
+    static constexpr size_t EVAL_CACHE_SIZE = 1u << 16;
+
+    class EvalCacheEntry {
+    public:
+        uint64_t key = 0;
+        int value = 0;
+        bool valid = false;
+    };
+
+    DynamicArray<EvalCacheEntry> evalCache_;
+    bool useEvalCache_ = true;
+
+    // MCTS: without a node or time limit the playout budget is maxDepth_ times
+    // MCTS_PLAYOUTS_PER_DEPTH. A leaf is expanded on its MCTS_EXPAND_VISITS-th
+    // visit into at most MCTS_MAX_CHILDREN moves, the ones with the highest priors.
+    // Classic leaf values weigh the static eval by MCTS_EVAL_WEIGHT.
+    static constexpr uint64_t MCTS_PLAYOUTS_PER_DEPTH = 1000;
+    static constexpr int MCTS_EXPAND_VISITS = 2;
+    static constexpr int MCTS_MAX_CHILDREN = 40;
+    static constexpr double MCTS_CPUCT = 1.5;
+    static constexpr double MCTS_FPU_REDUCTION = 0.1;
+    static constexpr double MCTS_EVAL_WEIGHT = 0.5;
+    SearchEngine searchEngine_ = SearchEngine::AlphaBeta;
+    // Root driver from depth 2 on: MTD(f) zero-window probes instead of aspiration windows.
+    bool useMtdf_ = false;
     uint64_t ttGeneration_ = 0;
+    uint64_t ttMinValidGeneration_ = 0;
+    bool carryTTGeneration_ = false;
 
     AIStatistics stats_;
 
@@ -254,8 +501,6 @@ private:
     void buildEvalTables(int rows, int cols, int winLen) {
         windows_.clear();
         cellWindows_.clear();
-        posValues_.clear();
-        windowWeight_.clear();
 
         int totalCells = rows * cols;
         cellWindows_.reserve(static_cast<size_t>(totalCells));
@@ -302,43 +547,14 @@ private:
             }
         }
 
-        windowWeight_.reserve(static_cast<size_t>(winLen + 1));
-        windowWeight_.push_back(0);
-        if (mode_ == GameMode::Classic) {
-            for (int i = 1; i <= winLen; ++i) {
-                int w = i * i * winLen;
-                if (i == winLen - 1) {
-                    w += winLen * winLen * 4;
-                }
-                if (i == winLen) {
-                    w = WIN_SCORE / 16;
-                }
-                windowWeight_.push_back(w);
-            }
-        } else {
-            int winScore = 2000 + winLen * 80;
-            for (int i = 1; i <= winLen; ++i) {
-                int w = i * i * winLen * 3;
-                if (i == winLen - 1) {
-                    w += winLen * winLen * 2;
-                }
-                if (i == winLen) {
-                    w = winScore;
-                }
-                windowWeight_.push_back(w);
-            }
-        }
-
-        int centerRow = rows / 2;
-        int centerCol = cols / 2;
-        int minSide = std::min(rows, cols);
-        posValues_.reserve(static_cast<size_t>(totalCells));
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                int centerDist = std::abs(row - centerRow) + std::abs(col - centerCol);
-                posValues_.push_back(minSide - centerDist);
-            }
+        EvalWeights w = EvalWeights::defaults(rows, cols, winLen, mode_, WIN_SCORE);
+        const EvalWeights* tuned = evalWeights_ ? evalWeights_->find(rows, cols, winLen, mode_) : nullptr;
+        if (tuned) {
+            for (int n = 1; n < winLen; ++n) w.window[n] = tuned->window[n];
+            w.cells = tuned->cells;
         }
+        windowWeight_ = std::move(w.window);
+        posValues_ = std::move(w.cells);
     }
 
     int64_t windowScoreForPlayer(int xCount, int oCount) const {
@@ -350,12 +566,259 @@ private:
         return 0;
     }
 
+    void adjustLive(int xCount, int oCount, int delta) {
+        if (oCount == 0 && xCount < evalWinLen_) {
+            liveWindows_[0] += delta;
+            liveByOwn_[0][xCount] += delta;
+        }
+        if (xCount == 0 && oCount < evalWinLen_) {
+            liveWindows_[1] += delta;
+            liveByOwn_[1][oCount] += delta;
+        }
+    }
+
+    void touchWindowCells(const WindowInfo& w, int delta) {
+        for (int k = 0; k < evalWinLen_; ++k) {
+            cellOpenWindows_[(w.row + k * w.dr) * evalCols_ + (w.col + k * w.dc)] += delta;
+        }
+    }
+
+    // What a window with these counts adds to the gain/threat maps of its cells.
+    void windowContribution(int xCount, int oCount, int gain[2], int64_t threat[2]) const {
+        gain[0] = (oCount == 0 && xCount == evalWinLen_ - 1) ? 1 : 0;
+        gain[1] = (xCount == 0 && oCount == evalWinLen_ - 1) ? 1 : 0;
+        threat[0] = 0;
+        threat[1] = 0;
+        if (xCount + oCount >= evalWinLen_) return;
+        int64_t base = windowScoreForPlayer(xCount, oCount);
+        threat[0] = windowScoreForPlayer(xCount + 1, oCount) - base;
+        threat[1] = windowScoreForPlayer(xCount, oCount + 1) - base;
+    }
+
+    // oldX < 0 means the window had no previous contribution.
+    void updateCellMaps(const WindowInfo& w, int oldX, int oldO, int newX, int newO) {
+        int gain[2] = { 0, 0 };
+        int64_t threat[2] = { 0, 0 };
+        windowContribution(newX, newO, gain, threat);
+        if (oldX >= 0) {
+            int oldGain[2];
+            int64_t oldThreat[2];
+            windowContribution(oldX, oldO, oldGain, oldThreat);
+            for (int side = 0; side < 2; ++side) {
+                gain[side] -= oldGain[side];
+                threat[side] -= oldThreat[side];
+            }
+        }
+        if (gain[0] == 0 && gain[1] == 0 && threat[0] == 0 && threat[1] == 0) return;
+        for (int k = 0; k < evalWinLen_; ++k) {
+            size_t c = static_cast<size_t>((w.row + k * w.dr) * evalCols_ + (w.col + k * w.dc));
+            for (int side = 0; side < 2; ++side) {
+                cellGain_[side].unchecked(c) += gain[side];
+                cellThreat_[side].unchecked(c) += threat[side];
+            }
+        }
+    }
+
+    int cellGain(const Coord& mv, CellState cell) const {
+        return cellGain_[cell == CellState::X ? 0 : 1][mv.row() * evalCols_ + mv.col()];
+    }
+
+    // |change of windowScoreSum_ + centerBias_| if `cell` were played at mv.
+    int64_t cellSwing(const Coord& mv, CellState cell) const {
+        int idx = mv.row() * evalCols_ + mv.col();
+        int64_t pos = posValues_[idx];
+        int64_t bias = (cell == playerToCell(player_)) ? pos : -pos;
+        return std::llabs(cellThreat_[cell == CellState::X ? 0 : 1][idx] + bias);
+    }
+
+    bool isDeadCell(const Coord& mv) const {
+        return cellOpenWindows_[mv.row() * evalCols_ + mv.col()] == 0;
+    }
+
+    // Dead cells are interchangeable (each is a pure tempo move), so one of them is
+    // enough; the rest only inflate the branching factor.
+    void dropDeadCells(const Board& board, DynamicArray<Coord>& moves) {
+        if (!dropDeadCells_ || !evalReady_ || board.getRows() != evalRows_ || board.getCols() != evalCols_ ||
+            board.getWinLength() != evalWinLen_ || evalMode_ != mode_) {
+            return;
+        }
+        size_t kept = 0;
+        bool haveDead = false;
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (isDeadCell(moves[i])) {
+                if (haveDead) {
+                    stats_.deadCellsPruned++;
+                    continue;
+                }
+                haveDead = true;
+            }
+            moves[kept++] = moves[i];
+        }
+        while (moves.size() > kept) moves.pop_back();
+    }
+
+    // Most credits a side can still earn with ownMoves stones: one per live window it
+    // can still fill, at most two per move.
+    int futureCreditBound(Player side, int ownMoves) const {
+        const DynamicArray<int>& byOwn = liveByOwn_[side == Player::X ? 0 : 1];
+        int live = 0;
+        for (int k = std::max(0, evalWinLen_ - ownMoves); k < evalWinLen_; ++k) live += byOwn[k];
+        return std::min(live, 2 * ownMoves);
+    }
+
+    // Bounds on the final differential * 1000 from player_'s perspective. Without a
+    // known side to move both sides are allowed the larger half of the empty cells.
+    void lineScoreBounds(const Board& board, int scoreX, int scoreO, const Player* toMove, int64_t& lower, int64_t& upper) const {
+        int empty = board.emptyCount();
+        int ownMoves = (empty + 1) / 2;
+        int oppMoves = ownMoves;
+        if (toMove && *toMove != player_) ownMoves = empty / 2;
+        if (toMove && *toMove == player_) oppMoves = empty / 2;
+        int64_t diff = baseScorePerspective(scoreX, scoreO);
+        upper = (diff + futureCreditBound(player_, ownMoves)) * 1000;
+        lower = (diff - futureCreditBound(opponent_, oppMoves)) * 1000;
+    }
+
+    // Classic: neither side can fill a live window with the moves it has left.
+    bool classicDeadDraw(const Board& board, Player toMove) const {
+        int empty = board.emptyCount();
+        int movesX = (toMove == Player::X) ? (empty + 1) / 2 : empty / 2;
+        return futureCreditBound(Player::X, movesX) == 0 &&
+               futureCreditBound(Player::O, empty - movesX) == 0;
+    }
+
+    // Shape score of one window for the side whose stones are `own` (1 = X, 2 = O).
+    // Fours and fives keep their window weight. Classic scales shorter shapes by how
+    // many flanks are still open; LinesScore credits every completed window whatever
+    // its flanks, so there a solid run of stones gets a bonus over a broken one.
+    int64_t patternShapeScore(const int* cells, int flankA, int flankB, int own) const {
+        int winLen = patternWinLen_;
+        int n = 0;
+        int first = -1;
+        int last = -1;
+        for (int k = 0; k < winLen; ++k) {
+            if (cells[k] == 0) continue;
+            if (cells[k] != own) return 0;
+            if (first < 0) first = k;
+            last = k;
+            ++n;
+        }
+        if (n == 0) return 0;
+        int64_t w = windowWeight_[n];
+        if (n >= winLen - 1) return w;
+        if (patternMode_ == GameMode::LinesScore) {
+            if (n >= 2 && last - first + 1 == n) w = w * 5 / 4;
+            return w;
+        }
+        int open = (flankA == 0 || flankA == own ? 1 : 0) + (flankB == 0 || flankB == own ? 1 : 0);
+        if (open == 2) w = w * 3 / 2;
+        else if (open == 0) w /= 2;
+        return w;
+    }
+
+    void buildPatternTables(int rows, int cols, int winLen) {
+        int pow3 = 1;
+        for (int k = 0; k < winLen; ++k) pow3 *= 3;
+        int codes = 16 * pow3;
+        patternWinLen_ = winLen;
+        patternMode_ = mode_;
+        patternValue_.clear();
+        patternValue_.reserve(static_cast<size_t>(codes));
+        int cells[PATTERN_MAX_WIN];
+        for (int code = 0; code < codes; ++code) {
+            int flankA = code % 4;
+            int flankB = (code / 4) % 4;
+            int rest = code / 16;
+            for (int k = 0; k < winLen; ++k) {
+                cells[k] = rest % 3;
+                rest /= 3;
+            }
+            int64_t v = patternShapeScore(cells, flankA, flankB, 1) - patternShapeScore(cells, flankA, flankB, 2);
+            patternValue_.push_back(clampScore(v));
+        }
+
+        cellPatterns_.clear();
+        cellPatterns_.reserve(static_cast<size_t>(rows * cols));
+        for (int i = 0; i < rows * cols; ++i) cellPatterns_.push_back(DynamicArray<std::pair<int,int>>());
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const WindowInfo& w = windows_[i];
+            int place = 16;
+            for (int k = 0; k < winLen; ++k) {
+                cellPatterns_[(w.row + k * w.dr) * cols + (w.col + k * w.dc)].push_back(std::pair<int,int>(static_cast<int>(i), place));
+                place *= 3;
+            }
+            int ar = w.row - w.dr;
+            int ac = w.col - w.dc;
+            if (ar >= 0 && ar < rows && ac >= 0 && ac < cols) {
+                cellPatterns_[ar * cols + ac].push_back(std::pair<int,int>(static_cast<int>(i), 1));
+            }
+            int br = w.row + winLen * w.dr;
+            int bc = w.col + winLen * w.dc;
+            if (br >= 0 && br < rows && bc >= 0 && bc < cols) {
+                cellPatterns_[br * cols + bc].push_back(std::pair<int,int>(static_cast<int>(i), 4));
+            }
+        }
+    }
+
+    static int patternDigit(CellState cell) {
+        return (cell == CellState::X) ? 1 : (cell == CellState::O ? 2 : 0);
+    }
+
+    // Called after the window tables are current; recomputes every code from the board.
+    void initPatterns(const Board& board) {
+        int rows = board.getRows();
+        int cols = board.getCols();
+        int winLen = board.getWinLength();
+        patternActive_ = (evalBackend_ == EvalBackend::Patterns && winLen <= PATTERN_MAX_WIN);
+        if (!patternActive_) return;
+        if (patternWinLen_ != winLen || patternMode_ != mode_) {
+            buildPatternTables(rows, cols, winLen);
+        }
+        patternCode_.clear();
+        patternCode_.reserve(windows_.size());
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const WindowInfo& w = windows_[i];
+            int ar = w.row - w.dr;
+            int ac = w.col - w.dc;
+            int br = w.row + winLen * w.dr;
+            int bc = w.col + winLen * w.dc;
+            int code = (ar >= 0 && ar < rows && ac >= 0 && ac < cols) ? 0 : 3;
+            code += (br >= 0 && br < rows && bc >= 0 && bc < cols) ? 0 : 12;
+            patternCode_.push_back(code);
+        }
+        for (int idx = 0; idx < rows * cols; ++idx) {
+            int digit = patternDigit(board.getNoCheck(idx / cols, idx % cols));
+            if (digit == 0) continue;
+            const DynamicArray<std::pair<int,int>>& refs = cellPatterns_[idx];
+            for (size_t i = 0; i < refs.size(); ++i) patternCode_[refs[i].first] += digit * refs[i].second;
+        }
+        patternSum_ = 0;
+        for (size_t i = 0; i < patternCode_.size(); ++i) patternSum_ += patternValue_[patternCode_[i]];
+    }
+
+    void updatePatterns(int idx, int delta) {
+        const DynamicArray<std::pair<int,int>>& refs = cellPatterns_[idx];
+        for (size_t i = 0; i < refs.size(); ++i) {
+            int& code = patternCode_.unchecked(static_cast<size_t>(refs[i].first));
+            patternSum_ -= patternValue_.unchecked(static_cast<size_t>(code));
+            code += delta * refs[i].second;
+            patternSum_ += patternValue_.unchecked(static_cast<size_t>(code));
+        }
+    }
+
+    // Shape total from player_'s perspective for the active backend.
+    int64_t shapeScore() const {
+        if (patternActive_) return (player_ == Player::X) ? patternSum_ : -patternSum_;
+        return windowScoreSum_;
+    }
+
     void initEvalCache(const Board& board) {
         int rows = board.getRows();
         int cols = board.getCols();
         int winLen = board.getWinLength();
         if (!evalReady_ || rows != evalRows_ || cols != evalCols_ || winLen != evalWinLen_ || evalMode_ != mode_) {
             buildEvalTables(rows, cols, winLen);
+            patternWinLen_ = 0;
             evalRows_ = rows;
             evalCols_ = cols;
             evalWinLen_ = winLen;
@@ -365,6 +828,21 @@ private:
 
         windowScoreSum_ = 0;
         centerBias_ = 0;
+        cellOpenWindows_.clear();
+        for (int i = 0; i < rows * cols; ++i) cellOpenWindows_.push_back(0);
+        for (int side = 0; side < 2; ++side) {
+            cellGain_[side].clear();
+            cellThreat_[side].clear();
+            for (int i = 0; i < rows * cols; ++i) {
+                cellGain_[side].push_back(0);
+                cellThreat_[side].push_back(0);
+            }
+        }
+        for (int side = 0; side < 2; ++side) {
+            liveWindows_[side] = 0;
+            liveByOwn_[side].clear();
+            for (int k = 0; k < winLen; ++k) liveByOwn_[side].push_back(0);
+        }
         for (size_t i = 0; i < windows_.size(); ++i) {
             WindowInfo& w = windows_[i];
             int xCount = 0;
@@ -379,6 +857,9 @@ private:
             w.xCount = xCount;
             w.oCount = oCount;
             windowScoreSum_ += windowScoreForPlayer(xCount, oCount);
+            adjustLive(xCount, oCount, 1);
+            if (xCount == 0 || oCount == 0) touchWindowCells(w, 1);
+            updateCellMaps(w, -1, -1, xCount, oCount);
         }
 
         CellState playerCell = playerToCell(player_);
@@ -393,6 +874,10 @@ private:
                 if (cell == playerCell) centerBias_ += pos;
                 else if (cell == opponentCell) centerBias_ -= pos;
         }
+        initPatterns(board);
+        neuralActive_ = (evalBackend_ == EvalBackend::Neural && neuralNet_ &&
+                         neuralNet_->matches(rows, cols, winLen, mode_));
+        if (neuralActive_) neuralNet_->refresh(board, neuralAcc_);
     }
 
     int applyMoveEval(Board& board, const Coord& mv, CellState cell) {
@@ -416,14 +901,22 @@ private:
             int64_t oldScore = windowScoreForPlayer(w.xCount, w.oCount);
             int ownCount = (cell == CellState::X) ? w.xCount : w.oCount;
             int oppCount = (cell == CellState::X) ? w.oCount : w.xCount;
+            adjustLive(w.xCount, w.oCount, -1);
+            int oldX = w.xCount;
+            int oldO = w.oCount;
             if (cell == CellState::X) ++w.xCount;
             else if (cell == CellState::O) ++w.oCount;
             int64_t newScore = windowScoreForPlayer(w.xCount, w.oCount);
             windowScoreSum_ += (newScore - oldScore);
+            adjustLive(w.xCount, w.oCount, 1);
+            updateCellMaps(w, oldX, oldO, w.xCount, w.oCount);
+            if (ownCount == 0 && oppCount > 0) touchWindowCells(w, -1);
             if (oppCount == 0 && ownCount + 1 == evalWinLen_) {
                 ++gained;
             }
         }
+        if (patternActive_) updatePatterns(idx, patternDigit(cell));
+        if (neuralActive_) neuralNet_->add(neuralAcc_, NeuralNet::feature(idx, cell));
         int pos = posValues_[idx];
         if (cell == playerToCell(player_)) centerBias_ += pos;
         else if (cell == playerToCell(opponent_)) centerBias_ -= pos;
@@ -448,11 +941,20 @@ private:
             int widx = wins[i];
             WindowInfo& w = windows_[widx];
             int64_t oldScore = windowScoreForPlayer(w.xCount, w.oCount);
+            bool wasBlocked = (w.xCount > 0 && w.oCount > 0);
+            adjustLive(w.xCount, w.oCount, -1);
+            int oldX = w.xCount;
+            int oldO = w.oCount;
             if (cell == CellState::X) --w.xCount;
             else if (cell == CellState::O) --w.oCount;
             int64_t newScore = windowScoreForPlayer(w.xCount, w.oCount);
             windowScoreSum_ += (newScore - oldScore);
+            adjustLive(w.xCount, w.oCount, 1);
+            updateCellMaps(w, oldX, oldO, w.xCount, w.oCount);
+            if (wasBlocked && (w.xCount == 0 || w.oCount == 0)) touchWindowCells(w, 1);
         }
+        if (patternActive_) updatePatterns(idx, -patternDigit(cell));
+        if (neuralActive_) neuralNet_->sub(neuralAcc_, NeuralNet::feature(idx, cell));
         int pos = posValues_[idx];
         if (cell == playerToCell(player_)) centerBias_ -= pos;
         else if (cell == playerToCell(opponent_)) centerBias_ += pos;
@@ -469,16 +971,33 @@ private:
     }
 
     
+    // The network's output from player_'s perspective; it replaces the shape and
+    // centre terms of the other backends.
+    int64_t neuralScore() const {
+        int64_t v = neuralNet_->evaluate(neuralAcc_);
+        return (player_ == Player::X) ? v : -v;
+    }
+
     int evaluateHeuristicClassic(const Board& board) const {
         (void)board;
-        return clampScore(windowScoreSum_ + centerBias_);
+        if (neuralActive_) return clampScore(neuralScore());
+        return clampScore(shapeScore() + centerBias_);
     }
 
     int evaluateHeuristicLines(const Board& board, int scoreX, int scoreO) const {
-        (void)board;
         int64_t score = static_cast<int64_t>(baseScorePerspective(scoreX, scoreO)) * 1000;
-        score += windowScoreSum_ / 2;
-        score += centerBias_ / 2;
+        if (neuralActive_) {
+            score += neuralScore();
+        } else {
+            score += shapeScore() / 2;
+            score += centerBias_ / 2;
+        }
+        if (useLineBounds_ && evalReady_) {
+            int64_t lower = 0;
+            int64_t upper = 0;
+            lineScoreBounds(board, scoreX, scoreO, nullptr, lower, upper);
+            score = std::max(lower, std::min(upper, score));
+        }
         return clampScore(score);
     }
 
@@ -593,15 +1112,11 @@ private:
         for (size_t i = 0; i < pool.size(); ++i) {
             const Coord& mv = pool[i];
             if (!board.isEmpty(mv.row(), mv.col())) continue;
-            int64_t baseScore = windowScoreSum_ + centerBias_;
-
-            int gainedSelf = applyMoveEval(board, mv, curCell);
-            int64_t deltaSelf = std::llabs((windowScoreSum_ + centerBias_) - baseScore);
-            undoMoveEval(board, mv, curCell);
-
-            int gainedOpp = applyMoveEval(board, mv, oppCell);
-            int64_t deltaOpp = std::llabs((windowScoreSum_ + centerBias_) - baseScore);
-            undoMoveEval(board, mv, oppCell);
+            if (dropDeadCells_ && isDeadCell(mv)) continue;
+            int gainedSelf = cellGain(mv, curCell);
+            int64_t deltaSelf = cellSwing(mv, curCell);
+            int gainedOpp = cellGain(mv, oppCell);
+            int64_t deltaOpp = cellSwing(mv, oppCell);
 
             if (gainedSelf >= 1 || gainedOpp >= 1 ||
                 (nearLineThreshold > 0 && (deltaSelf >= nearLineThreshold || deltaOpp >= nearLineThreshold))) {
@@ -638,6 +1153,47 @@ private:
                                        int depth,
                                        Player currentPlayer,
                                        DynamicArray<Coord>* mustPlayOut = nullptr) {
+        if (mode_ == GameMode::Classic && classicMustPlay_) {
+            DynamicArray<Coord> forced;
+            if (classicForcedMoves(board, currentPlayer, forced)) {
+                stats_.forcedMoveNodes++;
+                if (mustPlayOut) *mustPlayOut = forced;
+                return forced;
+            }
+        }
+        DynamicArray<Coord> moves = generateSearchMoves(board, depth, currentPlayer, mustPlayOut);
+        dropDeadCells(board, moves);
+        return moves;
+    }
+
+    // Classic: a window with winLen - 1 own stones and no opposing stone has exactly one
+    // empty cell, the winning one. With such a window the side to move wins at once;
+    // otherwise every cell completing an opponent window has to be blocked.
+    bool classicForcedMoves(const Board& board, Player currentPlayer, DynamicArray<Coord>& forced) const {
+        if (!evalReady_ || board.getRows() != evalRows_ || board.getCols() != evalCols_ ||
+            board.getWinLength() != evalWinLen_ || evalMode_ != mode_) {
+            return false;
+        }
+        int self = (currentPlayer == Player::X) ? 0 : 1;
+        int opp = 1 - self;
+        int side = -1;
+        if (liveByOwn_[self][evalWinLen_ - 1] > 0) side = self;
+        else if (liveByOwn_[opp][evalWinLen_ - 1] > 0) side = opp;
+        if (side < 0) return false;
+        int total = evalRows_ * evalCols_;
+        for (int idx = 0; idx < total; ++idx) {
+            if (cellGain_[side][idx] == 0) continue;
+            if (board.getNoCheck(idx / evalCols_, idx % evalCols_) != CellState::Empty) continue;
+            forced.push_back(Coord(idx / evalCols_, idx % evalCols_));
+            if (side == self) break;
+        }
+        return !forced.empty();
+    }
+
+    DynamicArray<Coord> generateSearchMoves(Board& board,
+                                            int depth,
+                                            Player currentPlayer,
+                                            DynamicArray<Coord>* mustPlayOut) {
         int rows = board.getRows();
         int cols = board.getCols();
         if (mode_ == GameMode::LinesScore && moveGenMode_ != MoveGenMode::Full) {
@@ -708,15 +1264,657 @@ private:
         return moves;
     }
 
-    int minimax(Board& board, int depth, int alpha, int beta, Player currentPlayer, bool isMaximizing, uint64_t hashKey, const Coord& lastMove, int scoreX, int scoreO, int extensionBudget) {
+    int cachedEval(const Board& board, uint64_t hashKey, int scoreX, int scoreO) {
+        if (!useEvalCache_) return evaluateHeuristic(board, scoreX, scoreO);
+        if (evalCache_.empty()) {
+            evalCache_.reserve(EVAL_CACHE_SIZE);
+            for (size_t i = 0; i < EVAL_CACHE_SIZE; ++i) evalCache_.push_back(EvalCacheEntry());
+        }
+        uint64_t key = makeHashKey(hashKey, board.getRows(), board.getCols(), board.getWinLength(), scoreX, scoreO);
+        EvalCacheEntry& e = evalCache_[key & (EVAL_CACHE_SIZE - 1)];
+        if (e.valid && e.key == key) {
+            stats_.evalCacheHits++;
+            return e.value;
+        }
+        stats_.evalCacheMisses++;
+        e.key = key;
+        e.value = evaluateHeuristic(board, scoreX, scoreO);
+        e.valid = true;
+        return e.value;
+    }
 
+    int horizonValue(Board& board, int alpha, int beta, Player currentPlayer, uint64_t hashKey, int scoreX, int scoreO) {
+        if (!useQuiescence_ || !evalReady_ || stats_.quiescenceNodes >= quiescenceNodeCap_) {
+            return cachedEval(board, hashKey, scoreX, scoreO);
+        }
+        return quiescence(board, alpha, beta, currentPlayer, hashKey, scoreX, scoreO, 0);
+    }
+
+    // Tactical moves for the quiescence search. Classic: the forced blocks when the
+    // opponent has a four, otherwise moves making a four (winLen >= 4). LinesScore:
+    // cells completing a line for the side to move.
+    void collectQuiescenceMoves(const Board& board, int self, bool mustBlock, DynamicArray<Coord>& out) const {
+        int other = 1 - self;
+        int total = evalRows_ * evalCols_;
+        if (mode_ == GameMode::Classic && !mustBlock) {
+            if (evalWinLen_ < 4) return;
+            DynamicArray<Coord> pool = board.getCandidateMoves(1);
+            for (size_t i = 0; i < pool.size(); ++i) {
+                const DynamicArray<int>& wins = cellWindows_[pool[i].row() * evalCols_ + pool[i].col()];
+                for (size_t j = 0; j < wins.size(); ++j) {
+                    const WindowInfo& w = windows_[wins[j]];
+                    int own = (self == 0) ? w.xCount : w.oCount;
+                    int opp = (self == 0) ? w.oCount : w.xCount;
+                    if (opp == 0 && own == evalWinLen_ - 2) {
+                        out.push_back(pool[i]);
+                        break;
+                    }
+                }
+            }
+            return;
+        }
+        if (mode_ == GameMode::LinesScore && liveByOwn_[self][evalWinLen_ - 1] == 0) return;
+        for (int idx = 0; idx < total; ++idx) {
+            bool tactical = (mode_ == GameMode::Classic) ? (cellGain_[other][idx] > 0) : (cellGain_[self][idx] > 0);
+            if (!tactical) continue;
+            if (board.getNoCheck(idx / evalCols_, idx % evalCols_) != CellState::Empty) continue;
+            out.push_back(Coord(idx / evalCols_, idx % evalCols_));
+        }
+    }
+
+    // Extends line completions and four threats past the horizon until the position is
+    // quiet. The side to move may stand pat unless a Classic four has to be blocked.
+    int quiescence(Board& board, int alpha, int beta, Player currentPlayer, uint64_t hashKey, int scoreX, int scoreO, int qply) {
+        if (isCancelled()) return evaluateHeuristic(board, scoreX, scoreO);
         stats_.nodesVisited++;
         stats_.nodes++;
+        stats_.quiescenceNodes++;
+
+        bool maximizing = (currentPlayer == player_);
+        if (board.isFull()) {
+            return (mode_ == GameMode::LinesScore) ? baseScorePerspective(scoreX, scoreO) * 1000 : 0;
+        }
+        int self = (currentPlayer == Player::X) ? 0 : 1;
+        bool mustBlock = false;
+        if (mode_ == GameMode::Classic) {
+            // The winning stone lands qply + 1 plies past the horizon; minimax
+            // scores a win by the remaining depth, which would be -(qply + 1) there.
+            if (liveByOwn_[self][evalWinLen_ - 1] > 0) {
+                return maximizing ? (WIN_SCORE - (qply + 1)) : (-WIN_SCORE + (qply + 1));
+            }
+            mustBlock = liveByOwn_[1 - self][evalWinLen_ - 1] > 0;
+        }
+        int standPat = cachedEval(board, hashKey, scoreX, scoreO);
+        if (isCancelled() || qply >= quiescencePlyCap_ || stats_.quiescenceNodes >= quiescenceNodeCap_) {
+            return standPat;
+        }
+        if (!mustBlock) {
+            if (maximizing) {
+                if (standPat >= beta) return standPat;
+                if (standPat > alpha) alpha = standPat;
+            } else {
+                if (standPat <= alpha) return standPat;
+                if (standPat < beta) beta = standPat;
+            }
+        }
+
+        DynamicArray<Coord> moves;
+        collectQuiescenceMoves(board, self, mustBlock, moves);
+        if (moves.empty()) return standPat;
+
+        int best = mustBlock ? (maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max()) : standPat;
+        CellState cell = playerToCell(currentPlayer);
+        Player next = getOpponent(currentPlayer);
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (i > 0 && stats_.quiescenceNodes >= quiescenceNodeCap_) break;
+            int gained = applyMoveEval(board, moves[i], cell);
+            int nextScoreX = scoreX;
+            int nextScoreO = scoreO;
+            if (mode_ == GameMode::LinesScore) {
+                int delta = std::min(2, std::max(0, gained));
+                if (cell == CellState::X) nextScoreX += delta;
+                else nextScoreO += delta;
+            }
+            uint64_t childHash = toggleToMove(hashKey, currentPlayer);
+            childHash = togglePiece(childHash, moves[i].row(), moves[i].col(), evalCols_, cell);
+            childHash = toggleToMove(childHash, next);
+            int v = quiescence(board, alpha, beta, next, childHash, nextScoreX, nextScoreO, qply + 1);
+            undoMoveEval(board, moves[i], cell);
+            if (maximizing) {
+                if (v > best) best = v;
+                if (best > alpha) alpha = best;
+            } else {
+                if (v < best) best = v;
+                if (best < beta) beta = best;
+            }
+            if (alpha >= beta) break;
+        }
+        return best;
+    }
+
+    static constexpr int NO_CUT = std::numeric_limits<int>::min() + 1;
+
+    // A line is one stone from completion for either side: passing or a shallow probe
+    // says nothing there.
+    bool threatsPending(Player currentPlayer) const {
+        if (!evalReady_) return true;
+        int self = (currentPlayer == Player::X) ? 0 : 1;
+        return liveByOwn_[self][evalWinLen_ - 1] > 0 || liveByOwn_[1 - self][evalWinLen_ - 1] > 0;
+    }
+
+    // Futility and ProbCut margins are in window weights; the pattern table and the
+    // network score on their own scales, so those prunings stay off under them.
+    bool windowMargins() const {
+        return !patternActive_ && !neuralActive_;
+    }
+
+    int probCutMargin() const {
+        if (mode_ == GameMode::LinesScore) return 1000;
+        return 2 * windowWeight_[evalWinLen_ - 1];
+    }
+
+    // Null move (verified by a reduced search of the node itself) and ProbCut. An extra
+    // stone never hurts in either mode, so passing is a safe lower bound. Returns the
+    // fail-hard bound on a cut, NO_CUT otherwise.
+    int forwardPrune(Board& board, int depth, int alpha, int beta, Player currentPlayer, bool isMaximizing,
+                     uint64_t hashKey, const Coord& lastMove, int scoreX, int scoreO, int extensionBudget) {
+        const int inf = std::numeric_limits<int>::max();
+        const int negInf = std::numeric_limits<int>::min();
+        bool cut = false;
+        allowForwardPruning_ = false;
+        if (useNullMove_ && depth >= NULL_MOVE_MIN_DEPTH && (isMaximizing ? beta < inf : alpha > negInf)) {
+            stats_.nullMoveTries++;
+            int reduction = (depth >= 6) ? 3 : 2;
+            Player next = getOpponent(currentPlayer);
+            uint64_t nullHash = toggleToMove(toggleToMove(hashKey, currentPlayer), next);
+            Coord none(-1, -1);
+            if (isMaximizing) {
+                int v = minimax(board, depth - 1 - reduction, beta - 1, beta, next, false, nullHash, none, scoreX, scoreO, 0);
+                if (v >= beta && !isCancelled()) {
+                    int verify = minimax(board, depth - reduction, beta - 1, beta, currentPlayer, true, hashKey, lastMove, scoreX, scoreO, extensionBudget);
+                    cut = (verify >= beta);
+                }
+            } else {
+                int v = minimax(board, depth - 1 - reduction, alpha, alpha + 1, next, true, nullHash, none, scoreX, scoreO, 0);
+                if (v <= alpha && !isCancelled()) {
+                    int verify = minimax(board, depth - reduction, alpha, alpha + 1, currentPlayer, false, hashKey, lastMove, scoreX, scoreO, extensionBudget);
+                    cut = (verify <= alpha);
+                }
+            }
+            if (cut) stats_.nullMoveCutoffs++;
+        }
+        if (!cut && useProbCut_ && windowMargins() && depth >= PROBCUT_MIN_DEPTH && !isCancelled()) {
+            int margin = probCutMargin();
+            if (isMaximizing && beta < inf - margin) {
+                stats_.probCutTries++;
+                int bound = beta + margin;
+                int v = minimax(board, depth - PROBCUT_REDUCTION, bound - 1, bound, currentPlayer, true, hashKey, lastMove, scoreX, scoreO, extensionBudget);
+                cut = (v >= bound);
+            } else if (!isMaximizing && alpha > negInf + margin) {
+                stats_.probCutTries++;
+                int bound = alpha - margin;
+                int v = minimax(board, depth - PROBCUT_REDUCTION, bound, bound + 1, currentPlayer, false, hashKey, lastMove, scoreX, scoreO, extensionBudget);
+                cut = (v <= bound);
+            }
+            if (cut) stats_.probCutCutoffs++;
+        }
+        allowForwardPruning_ = true;
+        if (!cut || isCancelled()) return NO_CUT;
+        return isMaximizing ? beta : alpha;
+    }
+
+    class PathGuard {
+    public:
+        PathGuard(DynamicArray<Coord>& path, const Coord& mv) : path_(path) { path_.push_back(mv); }
+        ~PathGuard() { path_.pop_back(); }
+        PathGuard(const PathGuard&) = delete;
+        PathGuard& operator=(const PathGuard&) = delete;
+
+    private:
+        DynamicArray<Coord>& path_;
+    };
+
+    // Same board size: decay what the previous search learned. Otherwise, and for
+    // deterministic searches, start from scratch.
+    void prepareHistory(int rows, int cols) {
+        size_t cells = static_cast<size_t>(rows * cols);
+        bool keep = !deterministic_ && historyCols_ == cols && history_[0].size() == cells;
+        for (int side = 0; side < 2; ++side) {
+            if (keep) {
+                for (size_t i = 0; i < cells; ++i) history_[side][i] /= 2;
+                continue;
+            }
+            history_[side].clear();
+            counterMoves_[side].clear();
+            followUps_[side].clear();
+            history_[side].reserve(cells);
+            counterMoves_[side].reserve(cells);
+            followUps_[side].reserve(cells);
+            for (size_t i = 0; i < cells; ++i) {
+                history_[side].push_back(0);
+                counterMoves_[side].push_back(Coord(-1, -1));
+                followUps_[side].push_back(Coord(-1, -1));
+            }
+        }
+        historyCols_ = cols;
+    }
+
+    int historyIndex(const Coord& mv) const {
+        if (historyCols_ <= 0 || mv.row() < 0 || mv.col() < 0) return -1;
+        int idx = mv.row() * historyCols_ + mv.col();
+        return (idx < static_cast<int>(history_[0].size())) ? idx : -1;
+    }
+
+    // Gravity update: scores saturate at HISTORY_MAX, below the killer bonuses.
+    void addHistory(Player side, const Coord& mv, int bonus) {
+        int idx = historyIndex(mv);
+        if (idx < 0) return;
+        bonus = std::min(bonus, HISTORY_MAX);
+        int& h = history_[side == Player::X ? 0 : 1][idx];
+        h += bonus - h * bonus / HISTORY_MAX;
+    }
+
+    void recordCutoff(Player currentPlayer, const Coord& mv, int depth, const Coord& lastMove) {
+        if (depth < MAX_KILLER_DEPTH) {
+            if (killerMoves_[depth][0] != mv) {
+                killerMoves_[depth][1] = killerMoves_[depth][0];
+                killerMoves_[depth][0] = mv;
+            }
+        }
+        addHistory(currentPlayer, mv, depth * depth);
+        int side = (currentPlayer == Player::X) ? 0 : 1;
+        int lastIdx = historyIndex(lastMove);
+        if (lastIdx >= 0) counterMoves_[side][lastIdx] = mv;
+        int ownIdx = historyIndex(ownPreviousMove());
+        if (ownIdx >= 0) followUps_[side][ownIdx] = mv;
+    }
+
+    // The side to move's own move two plies up, if the path has one.
+    Coord ownPreviousMove() const {
+        return (path_.size() >= 2) ? path_[path_.size() - 2] : Coord(-1, -1);
+    }
+
+    Coord counterMoveFor(Player currentPlayer, const Coord& lastMove) const {
+        int idx = historyIndex(lastMove);
+        return (idx >= 0) ? counterMoves_[currentPlayer == Player::X ? 0 : 1][idx] : Coord(-1, -1);
+    }
+
+    Coord followUpFor(Player currentPlayer) const {
+        int idx = historyIndex(ownPreviousMove());
+        return (idx >= 0) ? followUps_[currentPlayer == Player::X ? 0 : 1][idx] : Coord(-1, -1);
+    }
+
+    // Move generation and the caps change at these depths; a cached list is only
+    // reused within the same band.
+    static uint8_t orderCacheBucket(int depth) {
+        if (depth < 3) return 0;
+        if (depth < 6) return 1;
+        if (depth < 8) return 2;
+        return 3;
+    }
+
+    bool probeOrderCache(size_t key, int depth, int cols, DynamicArray<Coord>& moves, DynamicArray<int>& baseUrgency,
+                         DynamicArray<Coord>& mustPlay) {
+        if (!useOrderCache_) return false;
+        if (orderCache_.empty()) {
+            stats_.orderCacheMisses++;
+            return false;
+        }
+        const OrderCacheEntry& e = orderCache_[key & (ORDER_CACHE_SIZE - 1)];
+        if (e.count == 0 || e.key != key || e.generation < ttMinValidGeneration_ ||
+            e.depthBucket != orderCacheBucket(depth)) {
+            stats_.orderCacheMisses++;
+            return false;
+        }
+        stats_.orderCacheHits++;
+        for (int i = 0; i < e.count; ++i) {
+            int cell = e.cells[i] & ~ORDER_MUST_PLAY;
+            Coord mv(cell / cols, cell % cols);
+            moves.push_back(mv);
+            baseUrgency.push_back(e.baseUrgency[i]);
+            if (e.cells[i] & ORDER_MUST_PLAY) mustPlay.push_back(mv);
+        }
+        return true;
+    }
+
+    void storeOrderCache(size_t key, int depth, int cols, const DynamicArray<std::pair<Coord,int>>& order,
+                         const DynamicArray<Coord>& mustPlay) {
+        if (!useOrderCache_ || order.empty() || order.size() > static_cast<size_t>(ORDER_CACHE_MOVES)) return;
+        if (orderCache_.empty()) {
+            orderCache_.reserve(ORDER_CACHE_SIZE);
+            for (size_t i = 0; i < ORDER_CACHE_SIZE; ++i) orderCache_.push_back(OrderCacheEntry());
+        }
+        OrderCacheEntry& e = orderCache_[key & (ORDER_CACHE_SIZE - 1)];
+        e.key = key;
+        e.generation = ttGeneration_;
+        e.depthBucket = orderCacheBucket(depth);
+        e.count = static_cast<uint8_t>(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            const Coord& mv = order[i].first;
+            uint16_t cell = static_cast<uint16_t>(mv.row() * cols + mv.col());
+            for (size_t j = 0; j < mustPlay.size(); ++j) {
+                if (mustPlay[j] == mv) {
+                    cell |= ORDER_MUST_PLAY;
+                    break;
+                }
+            }
+            e.cells[i] = cell;
+            e.baseUrgency[i] = order[i].second;
+        }
+    }
+
+    int moveUrgency(const Board& board, const Coord& mv, bool heavy, Player currentPlayer, int depth, const Coord& ttHint,
+                    const DynamicArray<Coord>& mustPlay) const {
+        return staticUrgency(board, mv, heavy, currentPlayer, mustPlay) + dynamicUrgency(mv, currentPlayer, depth, ttHint);
+    }
+
+    // What the position alone says about the move: must-play, line gains or the centre.
+    int staticUrgency(const Board& board, const Coord& mv, bool heavy, Player currentPlayer,
+                      const DynamicArray<Coord>& mustPlay) const {
+        int bonus = 0;
+        CellState curCell = playerToCell(currentPlayer);
+        CellState oppCell = playerToCell(getOpponent(currentPlayer));
+        for (size_t i = 0; i < mustPlay.size(); ++i) {
+            if (mustPlay[i] == mv) {
+                bonus += 20000;
+                break;
+            }
+        }
+        int idx = mv.row() * board.getCols() + mv.col();
+        if (heavy && evalReady_) {
+            if (mode_ == GameMode::LinesScore) {
+                bonus += cellGain(mv, curCell) * 2500;
+                bonus += cellGain(mv, oppCell) * 1800;
+            } else {
+                if (cellGain(mv, curCell) > 0) bonus += 5000;
+                if (cellGain(mv, oppCell) > 0) bonus += 3000;
+            }
+        } else if (idx >= 0 && idx < static_cast<int>(posValues_.size())) {
+            bonus += posValues_[idx];
+        }
+        return bonus;
+    }
+
+    // What the search has learnt so far: history, killers and the TT move.
+    int dynamicUrgency(const Coord& mv, Player currentPlayer, int depth, const Coord& ttHint) const {
+        int bonus = 0;
+        int idx = historyIndex(mv);
+        const DynamicArray<int>& history = history_[currentPlayer == Player::X ? 0 : 1];
+        if (idx >= 0 && idx < static_cast<int>(history.size())) {
+            bonus += history[idx];
+        }
+        if (depth < MAX_KILLER_DEPTH) {
+            if (mv == killerMoves_[depth][0]) bonus += 4000;
+            else if (mv == killerMoves_[depth][1]) bonus += 3000;
+        }
+        if (mv == ttHint) bonus += 8000;
+        return bonus;
+    }
+
+    // Hands out a node's moves in stages: the TT hint before anything is generated,
+    // then killers, tactical moves (must-play, own line completions, Classic blocks)
+    // and the quiet rest, scored only once that stage is reached. A cutoff in an early
+    // stage skips the generation and scoring of the later ones.
+    class MovePicker {
+    public:
+        MovePicker(MinimaxAI& ai, Board& board, int depth, Player currentPlayer, const Coord& ttHint, size_t cacheKey,
+                   const Coord& lastMove)
+            : ai_(ai), board_(board), depth_(depth), player_(currentPlayer), ttHint_(ttHint), cacheKey_(cacheKey),
+              counter_(ai.counterMoveFor(currentPlayer, lastMove)), followUp_(ai.followUpFor(currentPlayer)) {}
+
+        bool next(Coord& mv, int& urgency) {
+            while (true) {
+                if (stage_ == Stage::TTMove) {
+                    stage_ = Stage::Generate;
+                    if (ttHint_.row() >= 0 && ttHint_.col() >= 0 && board_.isEmpty(ttHint_.row(), ttHint_.col())) {
+                        ttYielded_ = true;
+                        int base = ai_.staticUrgency(board_, ttHint_, true, player_, mustPlay_);
+                        return yield(ttHint_, base, base + dynamicScore(ttHint_), mv, urgency);
+                    }
+                } else if (stage_ == Stage::Generate) {
+                    generate();
+                    stage_ = Stage::Killers;
+                } else if (stage_ == Stage::Killers) {
+                    if (yielded_ >= cap_ || pos_ >= 4) {
+                        stage_ = Stage::Tactical;
+                        pos_ = 0;
+                        continue;
+                    }
+                    size_t slot = pos_++;
+                    Coord target = (slot == 2) ? counter_ : (slot == 3) ? followUp_ : Coord(-1, -1);
+                    if (slot < 2 && depth_ < MAX_KILLER_DEPTH) target = ai_.killerMoves_[depth_][slot];
+                    int idx = indexOf(target);
+                    if (idx < 0 || used_[idx]) continue;
+                    used_[idx] = 1;
+                    int u = scoreAt(static_cast<size_t>(idx), static_cast<size_t>(idx) < heavyBudget_);
+                    return yield(moves_[idx], base_[idx], u, mv, urgency);
+                } else if (stage_ == Stage::Tactical) {
+                    if (pos_ >= tactical_.size()) {
+                        if (!cached_) scoreQuiet();
+                        stage_ = Stage::Quiet;
+                        pos_ = 0;
+                        continue;
+                    }
+                    const std::pair<int,int>& p = tactical_[pos_++];
+                    if (used_[p.first]) continue;
+                    if (yielded_ >= cap_ && !isMustPlay(moves_[p.first])) continue;
+                    used_[p.first] = 1;
+                    return yield(moves_[p.first], base_[p.first], p.second, mv, urgency);
+                } else if (stage_ == Stage::Quiet) {
+                    if (yielded_ >= cap_ || pos_ >= quiet_.size()) {
+                        stage_ = Stage::Done;
+                        continue;
+                    }
+                    const std::pair<int,int>& p = quiet_[pos_++];
+                    if (used_[p.first]) continue;
+                    used_[p.first] = 1;
+                    return yield(moves_[p.first], base_[p.first], p.second, mv, urgency);
+                } else {
+                    return false;
+                }
+            }
+        }
+
+        bool isMustPlay(const Coord& mv) const {
+            for (size_t i = 0; i < mustPlay_.size(); ++i) {
+                if (mustPlay_[i] == mv) return true;
+            }
+            return false;
+        }
+
+        size_t generatedCount() const { return moves_.size(); }
+        const DynamicArray<Coord>& generatedMoves() const { return moves_; }
+        const DynamicArray<Coord>& mustPlayMoves() const { return mustPlay_; }
+        size_t cap() const { return cap_; }
+        size_t yielded() const { return yielded_; }
+        bool reachedQuiet() const { return stage_ == Stage::Quiet || stage_ == Stage::Done; }
+
+        // Stores the full order (searched moves, then the quiet ones a later visit
+        // would reach) once it is known, unless it came from the cache.
+        void saveOrder() {
+            if (cached_ || !reachedQuiet()) return;
+            DynamicArray<std::pair<Coord,int>> order = yieldedOrder_;
+            for (size_t i = pos_; i < quiet_.size() && order.size() < cap_; ++i) {
+                if (used_[quiet_[i].first]) continue;
+                order.push_back(std::pair<Coord,int>(moves_[quiet_[i].first], base_[quiet_[i].first]));
+            }
+            ai_.storeOrderCache(cacheKey_, depth_, board_.getCols(), order, mustPlay_);
+        }
+
+    private:
+        enum class Stage { TTMove, Generate, Killers, Tactical, Quiet, Done };
+
+        MinimaxAI& ai_;
+        Board& board_;
+        int depth_;
+        Player player_;
+        Coord ttHint_;
+        size_t cacheKey_;
+        Coord counter_;
+        Coord followUp_;
+        Stage stage_ = Stage::TTMove;
+        bool ttYielded_ = false;
+        bool cached_ = false;
+        DynamicArray<std::pair<Coord,int>> yieldedOrder_;
+        DynamicArray<Coord> moves_;
+        DynamicArray<Coord> mustPlay_;
+        DynamicArray<char> used_;
+        DynamicArray<int> base_;
+        DynamicArray<std::pair<int,int>> tactical_;
+        DynamicArray<std::pair<int,int>> quiet_;
+        size_t pos_ = 0;
+        size_t yielded_ = 0;
+        size_t cap_ = 0;
+        size_t heavyBudget_ = 0;
+
+        // Only the static part of an urgency is cached (in base_ and in the order
+        // cache); the search bonuses are re-applied whenever a move is scored, so a
+        // stale killer or TT bonus never steers LMR or pruning on a later visit.
+        int dynamicScore(const Coord& mv) const {
+            int u = ai_.dynamicUrgency(mv, player_, depth_, ttHint_);
+            if (mv == counter_) u += COUNTER_MOVE_BONUS;
+            if (mv == followUp_) u += FOLLOW_UP_BONUS;
+            return u;
+        }
+
+        int scoreAt(size_t idx, bool heavy) {
+            if (!cached_) base_[idx] = ai_.staticUrgency(board_, moves_[idx], heavy, player_, mustPlay_);
+            return base_[idx] + dynamicScore(moves_[idx]);
+        }
+
+        static bool byUrgency(const std::pair<int,int>& a, const std::pair<int,int>& b) {
+            return a.second > b.second;
+        }
+
+        bool yield(const Coord& c, int base, int u, Coord& mv, int& urgency) {
+            mv = c;
+            urgency = u;
+            ++yielded_;
+            yieldedOrder_.push_back(std::pair<Coord,int>(c, base));
+            return true;
+        }
+
+        int indexOf(const Coord& target) const {
+            if (target.row() < 0 || target.col() < 0) return -1;
+            for (size_t i = 0; i < moves_.size(); ++i) {
+                if (moves_[i] == target) return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        void generate() {
+            cached_ = ai_.probeOrderCache(cacheKey_, depth_, board_.getCols(), moves_, base_, mustPlay_);
+            if (!cached_) {
+                moves_ = ai_.getSearchMoves(board_, depth_, player_, &mustPlay_);
+                ai_.stats_.nodesGenerated += moves_.size();
+                ai_.stats_.generatedMoves += moves_.size();
+            }
+            used_.reserve(moves_.size());
+            for (size_t i = 0; i < moves_.size(); ++i) used_.push_back(0);
+            if (!cached_) {
+                base_.reserve(moves_.size());
+                for (size_t i = 0; i < moves_.size(); ++i) base_.push_back(0);
+                // The TT move was scored before the must-play list existed.
+                if (ttYielded_) yieldedOrder_[0].second = ai_.staticUrgency(board_, ttHint_, true, player_, mustPlay_);
+            }
+            // A TT move outside the list was searched on top of it, not instead of one of its moves.
+            size_t extra = 0;
+            if (ttYielded_) {
+                int idx = indexOf(ttHint_);
+                if (idx >= 0) used_[idx] = 1;
+                else extra = 1;
+            }
+            if (cached_) {
+                cap_ = moves_.size() + extra;
+                heavyBudget_ = moves_.size();
+                for (size_t i = 0; i < moves_.size(); ++i) {
+                    if (used_[i]) continue;
+                    quiet_.push_back(std::pair<int,int>(static_cast<int>(i), base_[i] + dynamicScore(moves_[i])));
+                }
+                std::stable_sort(quiet_.begin(), quiet_.end(), byUrgency);
+                return;
+            }
+
+            cap_ = moves_.size();
+            if (board_.getRows() * board_.getCols() >= 64) {
+                size_t areaCap = depth_ >= 6 ? static_cast<size_t>(24) : static_cast<size_t>(32);
+                if (cap_ > areaCap) cap_ = areaCap;
+            }
+            if (ai_.useLMR_ && ai_.hardLimitMs_ > 0 && depth_ >= 8 && moves_.size() > 1) {
+                size_t lmrCap = static_cast<size_t>(std::max(24, board_.getWinLength() * 6));
+                if (cap_ > lmrCap) cap_ = lmrCap;
+            }
+            cap_ += extra;
+            heavyBudget_ = std::min(moves_.size(), static_cast<size_t>(depth_ >= 6 ? 24 : 16));
+
+            CellState curCell = ai_.playerToCell(player_);
+            CellState oppCell = ai_.playerToCell(ai_.getOpponent(player_));
+            for (size_t i = 0; i < moves_.size(); ++i) {
+                if (used_[i]) continue;
+                bool tactical = isMustPlay(moves_[i]) ||
+                                (ai_.evalReady_ && (ai_.cellGain(moves_[i], curCell) > 0 ||
+                                                    (ai_.mode_ == GameMode::Classic && ai_.cellGain(moves_[i], oppCell) > 0)));
+                if (!tactical) continue;
+                tactical_.push_back(std::pair<int,int>(static_cast<int>(i), scoreAt(i, true)));
+            }
+            std::sort(tactical_.begin(), tactical_.end(), byUrgency);
+        }
+
+        void scoreQuiet() {
+            for (size_t i = 0; i < moves_.size(); ++i) {
+                if (used_[i]) continue;
+                bool heavy = (i < heavyBudget_);
+                quiet_.push_back(std::pair<int,int>(static_cast<int>(i), scoreAt(i, heavy)));
+            }
+            size_t topK = std::min(quiet_.size(), static_cast<size_t>(std::max(12, board_.getWinLength() * 3)));
+            if (quiet_.size() > topK) {
+                std::nth_element(quiet_.begin(), quiet_.begin() + topK, quiet_.end(), byUrgency);
+                std::sort(quiet_.begin(), quiet_.begin() + topK, byUrgency);
+            } else {
+                std::sort(quiet_.begin(), quiet_.end(), byUrgency);
+            }
+        }
+    };
+
+    // The node's static eval and the signed change a move would make to it; both
+    // from player_'s perspective.
+    int64_t futilityBase(const Board& board, uint64_t hashKey, int scoreX, int scoreO) {
+        return cachedEval(board, hashKey, scoreX, scoreO);
+    }
+
+    int64_t futilityDelta(const Coord& mv, CellState cell) const {
+        int idx = mv.row() * evalCols_ + mv.col();
+        int64_t pos = posValues_[idx];
+        int64_t delta = cellThreat_[cell == CellState::X ? 0 : 1][idx] + ((cell == playerToCell(player_)) ? pos : -pos);
+        return (mode_ == GameMode::Classic) ? delta : delta / 2;
+    }
+
+    int64_t futilityMargin(int depth) const {
+        int64_t w = windowWeight_[evalWinLen_ - 1];
+        return depth * ((mode_ == GameMode::Classic) ? w : w / 2);
+    }
+
+    static int lateMoveLimit(int depth) {
+        static const int limits[SHALLOW_PRUNE_DEPTH + 1] = { 0, 8, 12, 18 };
+        return limits[depth];
+    }
+
+    // Completes, blocks or builds toward a K-1 window: never pruned.
+    bool quietShallowMove(const Coord& mv, CellState cell, CellState oppCell) const {
+        if (cellGain(mv, cell) > 0 || cellGain(mv, oppCell) > 0) return false;
+        return cellSwing(mv, cell) < windowWeight_[evalWinLen_ - 1] / 2;
+    }
+
+    int minimax(Board& board, int depth, int alpha, int beta, Player currentPlayer, bool isMaximizing, uint64_t hashKey, const Coord& lastMove, int scoreX, int scoreO, int extensionBudget) {
 
         if (isCancelled()) {
             return evaluateHeuristic(board, scoreX, scoreO);
         }
 
+        stats_.nodesVisited++;
+        stats_.nodes++;
+        PathGuard pathGuard(path_, lastMove);
+
         int alphaOriginal = alpha;
         int betaOriginal  = beta;
         int rows = board.getRows();
@@ -749,17 +1947,38 @@ private:
             if (board.isFull()) {
                 return 0;
             }
+            if (evalReady_ && classicDeadDraw(board, currentPlayer)) {
+                stats_.deadDrawCutoffs++;
+                return 0;
+            }
             if (depth <= 0) {
-                return evaluateHeuristic(board, scoreX, scoreO);
+                return horizonValue(board, alpha, beta, currentPlayer, hashKey, scoreX, scoreO);
             }
         } else { 
             if (board.isFull()) {
                 
                 return baseScorePerspective(scoreX, scoreO) * 1000;
             }
+            if (useLineBounds_ && evalReady_) {
+                int64_t lower = 0;
+                int64_t upper = 0;
+                lineScoreBounds(board, scoreX, scoreO, &currentPlayer, lower, upper);
+                if (lower == upper) {
+                    stats_.boundCutoffs++;
+                    return clampScore(lower);
+                }
+                if (upper <= alpha) {
+                    stats_.boundCutoffs++;
+                    return clampScore(upper);
+                }
+                if (lower >= beta) {
+                    stats_.boundCutoffs++;
+                    return clampScore(lower);
+                }
+            }
             
             if (depth <= 0) {
-                return evaluateHeuristic(board, scoreX, scoreO);
+                return horizonValue(board, alpha, beta, currentPlayer, hashKey, scoreX, scoreO);
             }
         }
 
@@ -769,7 +1988,7 @@ private:
             stats_.ttProbes++;
             if (transpositionTable_.contains(key)) {
                 const TTEntry& e = transpositionTable_.get(key);
-                if (e.generation != ttGeneration_) {
+                if (e.generation < ttMinValidGeneration_) {
                     stats_.cacheMisses++;
                 } else if (e.depth >= depth) {
                     stats_.cacheHits++;
@@ -797,10 +2016,10 @@ private:
             }
         }
 
-        DynamicArray<Coord> mustPlay;
-        DynamicArray<Coord> moves = getSearchMoves(board, depth, currentPlayer, &mustPlay);
-        stats_.nodesGenerated += moves.size();
-        stats_.generatedMoves += moves.size();
+        if ((useNullMove_ || useProbCut_) && allowForwardPruning_ && lastMove.row() >= 0 && !threatsPending(currentPlayer)) {
+            int cut = forwardPrune(board, depth, alpha, beta, currentPlayer, isMaximizing, hashKey, lastMove, scoreX, scoreO, extensionBudget);
+            if (cut != NO_CUT) return cut;
+        }
 
         Coord ttHint(-1, -1);
         
@@ -808,173 +2027,18 @@ private:
             size_t key = makeHashKey(hashKey, rows, cols, winLen, scoreX, scoreO);
             if (transpositionTable_.contains(key)) {
                 const TTEntry& e = transpositionTable_.get(key);
-                if (e.generation == ttGeneration_ &&
-                    e.depth >= depth &&
+                if (e.generation >= ttMinValidGeneration_ &&
                     e.bestMove.move.row() >= 0 && e.bestMove.move.col() >= 0) {
                     ttHint = e.bestMove.move;
                 }
             }
         }
 
-        auto isMustPlayMove = [&](const Coord& mv) -> bool {
-            for (size_t i = 0; i < mustPlay.size(); ++i) {
-                if (mustPlay[i] == mv) return true;
-            }
-            return false;
-        };
-
-        auto moveUrgency = [&](const Coord& mv, bool heavy) -> int {
-            int bonus = 0;
-            Board& b = board;
-            CellState curCell = playerToCell(currentPlayer);
-            CellState oppCell = playerToCell(getOpponent(currentPlayer));
-            if (!mustPlay.empty() && isMustPlayMove(mv)) {
-                bonus += 20000;
-            }
-            if (heavy) {
-                if (mode_ == GameMode::LinesScore) {
-                    int gainedSelf = applyMoveEval(b, mv, curCell);
-                    bonus += gainedSelf * 2500;
-                    undoMoveEval(b, mv, curCell);
-
-                    int gainedOpp = applyMoveEval(b, mv, oppCell);
-                    bonus += gainedOpp * 1800;
-                    undoMoveEval(b, mv, oppCell);
-                } else {
-                    applyMoveEval(b, mv, curCell);
-                    if (b.checkWinFromMove(mv, curCell)) bonus += 5000;
-                    undoMoveEval(b, mv, curCell);
-
-                    applyMoveEval(b, mv, oppCell);
-                    if (b.checkWinFromMove(mv, oppCell)) bonus += 3000;
-                    undoMoveEval(b, mv, oppCell);
-                }
-            } else {
-                int idx = mv.row() * b.getCols() + mv.col();
-                if (idx >= 0 && idx < static_cast<int>(posValues_.size())) {
-                    bonus += posValues_[idx];
-                }
-            }
-
-            int idx = mv.row() * b.getCols() + mv.col();
-            if (historyTable_ && idx >= 0 && idx < static_cast<int>(historyTable_->size())) {
-                bonus += (*historyTable_)[idx];
-            }
-            if (depth < MAX_KILLER_DEPTH) {
-                if (mv == killerMoves_[depth][0]) bonus += 4000;
-                else if (mv == killerMoves_[depth][1]) bonus += 3000;
-            }
-            if (mv == ttHint) bonus += 8000;
-            return bonus;
-        };
-
-        DynamicArray<std::pair<Coord,int>> moveList;
-        moveList.reserve(moves.size());
-        size_t heavyBudget = std::min(moves.size(), static_cast<size_t>(depth >= 6 ? 24 : 16));
-        for (size_t i = 0; i < moves.size(); ++i) {
-            bool heavy = (i < heavyBudget);
-            moveList.push_back(std::pair<Coord,int>(moves[i], moveUrgency(moves[i], heavy)));
-        }
-
-        auto cmpUrgency = [](const std::pair<Coord,int>& a, const std::pair<Coord,int>& b) {
-            return a.second > b.second;
-        };
-
-        DynamicArray<char> used;
-        used.reserve(moveList.size());
-        for (size_t i = 0; i < moveList.size(); ++i) used.push_back(0);
-
-        DynamicArray<std::pair<Coord,int>> ordered;
-        ordered.reserve(moveList.size());
-
-        auto takeIfPresent = [&](const Coord& target) {
-            if (target.row() < 0 || target.col() < 0) return;
-            for (size_t i = 0; i < moveList.size(); ++i) {
-                if (used[i]) continue;
-                if (moveList[i].first == target) {
-                    used[i] = 1;
-                    ordered.push_back(moveList[i]);
-                    return;
-                }
-            }
-        };
-
-        if (ttHint.row() >= 0 && ttHint.col() >= 0) {
-            takeIfPresent(ttHint);
-        }
-        if (depth < MAX_KILLER_DEPTH) {
-            takeIfPresent(killerMoves_[depth][0]);
-            takeIfPresent(killerMoves_[depth][1]);
-        }
-
-        DynamicArray<std::pair<Coord,int>> rest;
-        rest.reserve(moveList.size());
-        for (size_t i = 0; i < moveList.size(); ++i) {
-            if (!used[i]) rest.push_back(moveList[i]);
-        }
-
-        size_t topKBase = static_cast<size_t>(std::max(12, winLen * 3));
-        size_t topK = std::min(rest.size(), topKBase);
-        if (topK > 0) {
-            if (rest.size() > topK) {
-                std::nth_element(rest.begin(), rest.begin() + topK, rest.end(), cmpUrgency);
-                std::sort(rest.begin(), rest.begin() + topK, cmpUrgency);
-            } else {
-                std::sort(rest.begin(), rest.end(), cmpUrgency);
-            }
-            for (size_t i = 0; i < topK; ++i) ordered.push_back(rest[i]);
-            for (size_t i = topK; i < rest.size(); ++i) ordered.push_back(rest[i]);
-        } else {
-            for (size_t i = 0; i < rest.size(); ++i) ordered.push_back(rest[i]);
-        }
-
-        moves.clear();
-        DynamicArray<int> urgencies;
-        urgencies.reserve(ordered.size());
-        for (const auto& p : ordered) {
-            moves.push_back(p.first);
-            urgencies.push_back(p.second);
-        }
-
+        MovePicker picker(*this, board, depth, currentPlayer, ttHint, makeHashKey(hashKey, rows, cols, winLen, scoreX, scoreO), lastMove);
         int       bestScore;
         CellState currentCell = playerToCell(currentPlayer);
         CellState opponentCell = playerToCell(getOpponent(currentPlayer));
         Coord bestMoveCoord(-1, -1);
-        size_t cap = moves.size();
-        int area = rows * cols;
-        if (area >= 64) {
-            size_t areaCap = depth >= 6 ? static_cast<size_t>(24) : static_cast<size_t>(32);
-            if (cap > areaCap) cap = areaCap;
-        }
-        if (useLMR_ && timeLimitMs_ > 0 && depth >= 8 && moves.size() > 1) {
-            size_t lmrCap = static_cast<size_t>(std::max(24, winLen * 6));
-            if (cap > lmrCap) cap = lmrCap;
-        }
-        if (cap < moves.size()) {
-            DynamicArray<Coord> trimmedMoves;
-            DynamicArray<int> trimmedUrgencies;
-            trimmedMoves.reserve(std::min(moves.size(), cap + mustPlay.size()));
-            trimmedUrgencies.reserve(std::min(urgencies.size(), cap + mustPlay.size()));
-
-            for (size_t i = 0; i < moves.size(); ++i) {
-                if (!isMustPlayMove(moves[i])) continue;
-                trimmedMoves.push_back(moves[i]);
-                trimmedUrgencies.push_back(urgencies[i]);
-            }
-
-            if (mustPlay.size() < cap) {
-                for (size_t i = 0; i < moves.size(); ++i) {
-                    if (isMustPlayMove(moves[i])) continue;
-                    trimmedMoves.push_back(moves[i]);
-                    trimmedUrgencies.push_back(urgencies[i]);
-                    if (trimmedMoves.size() >= cap) break;
-                }
-            }
-            moves = std::move(trimmedMoves);
-            urgencies = std::move(trimmedUrgencies);
-        }
-        size_t maxMoves = moves.size();
-        stats_.expandedMoves += maxMoves;
         int64_t quietThreshold = 0;
         if (mode_ == GameMode::LinesScore && enableLMRLines_) {
             if (winLen - 1 >= 1 && static_cast<size_t>(winLen - 1) < windowWeight_.size()) {
@@ -984,53 +2048,68 @@ private:
             }
         }
         static constexpr size_t LMR_START = 8;
+        bool shallowPrune = useShallowPruning_ && evalReady_ && windowMargins() && depth >= 1 && depth <= SHALLOW_PRUNE_DEPTH &&
+                            alpha > -WIN_SCORE / 2 && beta < WIN_SCORE / 2 &&
+                            ((mode_ == GameMode::LinesScore && depth == 1) || !threatsPending(currentPlayer));
+        int64_t shallowBase = shallowPrune ? futilityBase(board, hashKey, scoreX, scoreO) : 0;
+        int64_t shallowMargin = shallowPrune ? futilityMargin(depth) : 0;
 
         if (isMaximizing) {
             bestScore = std::numeric_limits<int>::min();
 
-            for (size_t i = 0; i < maxMoves; ++i) {
+            Coord mv;
+            int urgency = 0;
+            for (size_t i = 0; picker.next(mv, urgency); ++i) {
                 int nextDepth = depth - 1;
                 int nextExtensionBudget = extensionBudget;
-                int urgency = (i < urgencies.size()) ? urgencies[i] : moveUrgency(moves[i], false);
                 bool considerLmrLines = (mode_ == GameMode::LinesScore &&
-                                         useLMR_ && enableLMRLines_ && timeLimitMs_ > 0 &&
-                                         depth >= 8 && moves.size() > 12 &&
+                                         useLMR_ && enableLMRLines_ && hardLimitMs_ > 0 &&
+                                         depth >= 8 && picker.generatedCount() > 12 &&
                                          i >= LMR_START && urgency < 4000 &&
-                                         !isMustPlayMove(moves[i]));
-                int64_t baseScore = 0;
+                                         !picker.isMustPlay(mv));
+                if (shallowPrune && i > 0 && urgency < 3000 && !picker.isMustPlay(mv) &&
+                    quietShallowMove(mv, currentCell, opponentCell)) {
+                    if (i >= static_cast<size_t>(lateMoveLimit(depth))) {
+                        stats_.lateMovePruned[depth]++;
+                        continue;
+                    }
+                    if (shallowBase + futilityDelta(mv, currentCell) + shallowMargin <= alpha) {
+                        stats_.futilityPruned[depth]++;
+                        continue;
+                    }
+                }
+                int64_t deltaScore = 0;
                 int gainedOpp = 0;
                 if (considerLmrLines) {
-                    baseScore = windowScoreSum_ + centerBias_;
-                    gainedOpp = applyMoveEval(board, moves[i], opponentCell);
-                    undoMoveEval(board, moves[i], opponentCell);
+                    deltaScore = cellSwing(mv, currentCell);
+                    gainedOpp = cellGain(mv, opponentCell);
                 }
-                int gained = applyMoveEval(board, moves[i], currentCell);
+                int gained = applyMoveEval(board, mv, currentCell);
                 bool tactical = (mode_ == GameMode::LinesScore && gained > 0) || urgency >= 3000;
                 if (useExtensions_ && tactical && mode_ == GameMode::LinesScore && gained > 0 && depth <= 6 && extensionBudget > 0) {
                     nextDepth = depth;
                     nextExtensionBudget = extensionBudget - 1;
                 } else if (mode_ == GameMode::LinesScore) {
                     if (considerLmrLines && quietThreshold > 0) {
-                        int64_t deltaScore = std::llabs((windowScoreSum_ + centerBias_) - baseScore);
                         bool quiet = (gained == 0 && deltaScore < quietThreshold && gainedOpp == 0);
                         if (quiet) {
                             nextDepth = depth - 2;
-                            if (depth >= 10 && moves.size() > 18 && i > 14 && urgency < 2000) {
+                            if (depth >= 10 && picker.generatedCount() > 18 && i > 14 && urgency < 2000) {
                                 nextDepth = depth - 3;
                             }
                             if (nextDepth < 1) nextDepth = 1;
                         }
                     }
-                } else if (useLMR_ && !tactical && timeLimitMs_ > 0 && depth >= 8 && moves.size() > 12 && i > 8 && urgency < 4000) {
+                } else if (useLMR_ && !tactical && hardLimitMs_ > 0 && depth >= 8 && picker.generatedCount() > 12 && i > 8 && urgency < 4000) {
                     nextDepth = depth - 2;
-                    if (depth >= 10 && moves.size() > 18 && i > 14 && urgency < 2000) {
+                    if (depth >= 10 && picker.generatedCount() > 18 && i > 14 && urgency < 2000) {
                         nextDepth = depth - 3;
                     }
                     if (nextDepth < 1) nextDepth = 1;
                 }
                 uint64_t childHash = hashKey;
                 childHash = toggleToMove(childHash, currentPlayer);
-                childHash = togglePiece(childHash, moves[i].row(), moves[i].col(), cols, currentCell);
+                childHash = togglePiece(childHash, mv.row(), mv.col(), cols, currentCell);
                 childHash = toggleToMove(childHash, getOpponent(currentPlayer));
 
                 int nextScoreX = scoreX;
@@ -1044,22 +2123,22 @@ private:
                 int score;
                 if (i == 0 || static_cast<long long>(alpha) >= static_cast<long long>(beta) - 1) {
                     score = minimax(board, nextDepth, alpha, beta,
-                                    getOpponent(currentPlayer), false, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                    getOpponent(currentPlayer), false, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                 } else {
                     int scout = minimax(board, nextDepth, alpha, alpha + 1,
-                                        getOpponent(currentPlayer), false, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                        getOpponent(currentPlayer), false, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                     if (scout > alpha && scout < beta) {
                         score = minimax(board, nextDepth, alpha, beta,
-                                        getOpponent(currentPlayer), false, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                        getOpponent(currentPlayer), false, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                     } else {
                         score = scout;
                     }
                 }
-                undoMoveEval(board, moves[i], currentCell);
+                undoMoveEval(board, mv, currentCell);
 
                 if (score > bestScore) {
                     bestScore = score;
-                    bestMoveCoord = moves[i];
+                    bestMoveCoord = mv;
                 }
                 alpha = std::max(alpha, bestScore);
 
@@ -1067,61 +2146,66 @@ private:
                     break;
                 }
                 if (beta <= alpha) {
-                    if (depth < MAX_KILLER_DEPTH) {
-                        if (killerMoves_[depth][0] != moves[i]) {
-                            killerMoves_[depth][1] = killerMoves_[depth][0];
-                            killerMoves_[depth][0] = moves[i];
-                        }
-                    }
+                    recordCutoff(currentPlayer, mv, depth, lastMove);
                     break;
                 }
             }
         } else {
             bestScore = std::numeric_limits<int>::max();
 
-            for (size_t i = 0; i < maxMoves; ++i) {
+            Coord mv;
+            int urgency = 0;
+            for (size_t i = 0; picker.next(mv, urgency); ++i) {
                 int nextDepth = depth - 1;
                 int nextExtensionBudget = extensionBudget;
-                int urgency = (i < urgencies.size()) ? urgencies[i] : moveUrgency(moves[i], false);
                 bool considerLmrLines = (mode_ == GameMode::LinesScore &&
-                                         useLMR_ && enableLMRLines_ && timeLimitMs_ > 0 &&
-                                         depth >= 8 && moves.size() > 12 &&
+                                         useLMR_ && enableLMRLines_ && hardLimitMs_ > 0 &&
+                                         depth >= 8 && picker.generatedCount() > 12 &&
                                          i >= LMR_START && urgency < 4000 &&
-                                         !isMustPlayMove(moves[i]));
-                int64_t baseScore = 0;
+                                         !picker.isMustPlay(mv));
+                if (shallowPrune && i > 0 && urgency < 3000 && !picker.isMustPlay(mv) &&
+                    quietShallowMove(mv, currentCell, opponentCell)) {
+                    if (i >= static_cast<size_t>(lateMoveLimit(depth))) {
+                        stats_.lateMovePruned[depth]++;
+                        continue;
+                    }
+                    if (shallowBase + futilityDelta(mv, currentCell) - shallowMargin >= beta) {
+                        stats_.futilityPruned[depth]++;
+                        continue;
+                    }
+                }
+                int64_t deltaScore = 0;
                 int gainedOpp = 0;
                 if (considerLmrLines) {
-                    baseScore = windowScoreSum_ + centerBias_;
-                    gainedOpp = applyMoveEval(board, moves[i], opponentCell);
-                    undoMoveEval(board, moves[i], opponentCell);
+                    deltaScore = cellSwing(mv, currentCell);
+                    gainedOpp = cellGain(mv, opponentCell);
                 }
-                int gained = applyMoveEval(board, moves[i], currentCell);
+                int gained = applyMoveEval(board, mv, currentCell);
                 bool tactical = (mode_ == GameMode::LinesScore && gained > 0) || urgency >= 3000;
                 if (useExtensions_ && tactical && mode_ == GameMode::LinesScore && gained > 0 && depth <= 6 && extensionBudget > 0) {
                     nextDepth = depth;
                     nextExtensionBudget = extensionBudget - 1;
                 } else if (mode_ == GameMode::LinesScore) {
                     if (considerLmrLines && quietThreshold > 0) {
-                        int64_t deltaScore = std::llabs((windowScoreSum_ + centerBias_) - baseScore);
                         bool quiet = (gained == 0 && deltaScore < quietThreshold && gainedOpp == 0);
                         if (quiet) {
                             nextDepth = depth - 2;
-                            if (depth >= 10 && moves.size() > 18 && i > 14 && urgency < 2000) {
+                            if (depth >= 10 && picker.generatedCount() > 18 && i > 14 && urgency < 2000) {
                                 nextDepth = depth - 3;
                             }
                             if (nextDepth < 1) nextDepth = 1;
                         }
                     }
-                } else if (useLMR_ && !tactical && timeLimitMs_ > 0 && depth >= 8 && moves.size() > 12 && i > 8 && urgency < 4000) {
+                } else if (useLMR_ && !tactical && hardLimitMs_ > 0 && depth >= 8 && picker.generatedCount() > 12 && i > 8 && urgency < 4000) {
                     nextDepth = depth - 2;
-                    if (depth >= 10 && moves.size() > 18 && i > 14 && urgency < 2000) {
+                    if (depth >= 10 && picker.generatedCount() > 18 && i > 14 && urgency < 2000) {
                         nextDepth = depth - 3;
                     }
                     if (nextDepth < 1) nextDepth = 1;
                 }
                 uint64_t childHash = hashKey;
                 childHash = toggleToMove(childHash, currentPlayer);
-                childHash = togglePiece(childHash, moves[i].row(), moves[i].col(), cols, currentCell);
+                childHash = togglePiece(childHash, mv.row(), mv.col(), cols, currentCell);
                 childHash = toggleToMove(childHash, getOpponent(currentPlayer));
 
                 int nextScoreX = scoreX;
@@ -1135,22 +2219,22 @@ private:
                 int score;
                 if (i == 0 || static_cast<long long>(alpha) >= static_cast<long long>(beta) - 1) {
                     score = minimax(board, nextDepth, alpha, beta,
-                                    getOpponent(currentPlayer), true, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                    getOpponent(currentPlayer), true, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                 } else {
                     int scout = minimax(board, nextDepth, beta - 1, beta,
-                                        getOpponent(currentPlayer), true, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                        getOpponent(currentPlayer), true, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                     if (scout > alpha && scout < beta) {
                         score = minimax(board, nextDepth, alpha, beta,
-                                        getOpponent(currentPlayer), true, childHash, moves[i], nextScoreX, nextScoreO, nextExtensionBudget);
+                                        getOpponent(currentPlayer), true, childHash, mv, nextScoreX, nextScoreO, nextExtensionBudget);
                     } else {
                         score = scout;
                     }
                 }
-                undoMoveEval(board, moves[i], currentCell);
+                undoMoveEval(board, mv, currentCell);
 
                 if (score < bestScore) {
                     bestScore = score;
-                    bestMoveCoord = moves[i];
+                    bestMoveCoord = mv;
                 }
                 beta = std::min(beta, bestScore);
 
@@ -1158,18 +2242,19 @@ private:
                     break;
                 }
                 if (beta <= alpha) {
-                    if (depth < MAX_KILLER_DEPTH) {
-                        if (killerMoves_[depth][0] != moves[i]) {
-                            killerMoves_[depth][1] = killerMoves_[depth][0];
-                            killerMoves_[depth][0] = moves[i];
-                        }
-                    }
+                    recordCutoff(currentPlayer, mv, depth, lastMove);
                     break;
                 }
             }
         }
 
-        if (useMemoization_) {
+        stats_.expandedMoves += picker.yielded();
+        if (beta <= alpha && !picker.reachedQuiet()) stats_.stagedCutoffs++;
+        if (!isCancelled()) picker.saveOrder();
+
+        // A cancelled node's children returned static evals, so its score is not worth
+        // its depth; a later search may trust this generation (ponder miss).
+        if (useMemoization_ && !isCancelled()) {
             size_t key = makeHashKey(hashKey, rows, cols, winLen, scoreX, scoreO);
             TTEntry entry;
             entry.score = bestScore;
@@ -1196,16 +2281,138 @@ private:
         return bestScore;
     }
 
-    bool timeExceeded() const {
-        if (timeLimitMs_ <= 0) return false;
+    long long elapsedSinceStartMs() const {
         auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime_).count();
-        return elapsed >= timeLimitMs_;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime_).count();
+    }
+
+    bool timeExceeded() const {
+        if (hardLimitMs_ <= 0) return false;
+        ++clockPolls_;
+        if (elapsedSinceStartMs() < hardLimitMs_) return false;
+        stopped_ = true;
+        stopReferenceMs_ = hardLimitMs_;
+        return true;
     }
 
+    void markStopped() const {
+        stopped_ = true;
+        stopReferenceMs_ = elapsedSinceStartMs();
+    }
+
+    // Called at every node and after every child, so the clock is only read every
+    // clockPollInterval_ calls; the stop is latched so unwinding never re-polls.
     bool isCancelled() const {
-        bool external = cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed);
-        return external || timeExceeded();
+        if (stopped_) return true;
+        if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) {
+            markStopped();
+            return true;
+        }
+        if (activeNodeLimit_ > 0 && stats_.nodes >= activeNodeLimit_) {
+            markStopped();
+            return true;
+        }
+        if (hardLimitMs_ <= 0) return false;
+        if (++pollCountdown_ < clockPollInterval_) return false;
+        pollCountdown_ = 0;
+        return timeExceeded();
+    }
+
+    void resetSearchControl() {
+        activeNodeLimit_ = nodeLimit_;
+        pollCountdown_ = 0;
+        clockPolls_ = 0;
+        stopped_ = false;
+        stopReferenceMs_ = 0;
+    }
+
+    void finishSearchControl() {
+        stats_.clockPolls += clockPolls_;
+        stats_.nodeLimitHit = activeNodeLimit_ > 0 && stats_.nodes >= activeNodeLimit_;
+        stats_.stopLatencyMs = stopped_ ? std::max(0LL, stats_.timeMs - stopReferenceMs_) : 0;
+    }
+
+    static uint64_t mixSignature(uint64_t h, uint64_t v) {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        return h ^ (h >> 29);
+    }
+
+    static uint64_t searchSignature(uint64_t nodes, const Coord& move, int completedDepth) {
+        uint64_t h = mixSignature(0, nodes);
+        h = mixSignature(h, static_cast<uint64_t>(static_cast<uint32_t>(move.row())) << 32 |
+                               static_cast<uint32_t>(move.col()));
+        return mixSignature(h, static_cast<uint64_t>(completedDepth));
+    }
+
+    // VCF first, then the wider VCT; both share one node budget. Only a VCF win
+    // is proven, and it is scored just below a win found by the main search. A VCT
+    // line leaves its first move in hint for root ordering.
+    bool solveThreats(const Board& board, MoveEvaluation& out, Coord& hint) {
+        ThreatSearch threats(board);
+        threats.setCancelFlag(cancelFlag_);
+        threats.setNodeBudget(threatNodeBudget_);
+        if (hardLimitMs_ > 0) {
+            threats.setDeadline(startTime_ + std::chrono::milliseconds(hardLimitMs_ / 2));
+        }
+        DynamicArray<Coord> line;
+        bool found = threats.findVCF(playerToCell(player_), line);
+        if (!found && !threats.budgetExhausted()) {
+            if (threats.findVCT(playerToCell(player_), line) && !line.empty() && board.isEmpty(line[0])) {
+                hint = line[0];
+            }
+        }
+        stats_.threatNodes += threats.nodes();
+        if (!found || line.empty() || !board.isEmpty(line[0])) return false;
+        stats_.threatWin = true;
+        out = MoveEvaluation(line[0], WIN_SCORE - static_cast<int>(line.size()));
+        return true;
+    }
+
+    // Proven wins and draws are final; a proven loss is left to the main search,
+    // which picks the longest resistance.
+    bool solveExactly(const Board& board, int emptyCells, MoveEvaluation& out) {
+        ProofNumberSearch pns(board);
+        pns.setCancelFlag(cancelFlag_);
+        pns.setNodeBudget(proofNodeBudget_);
+        if (hardLimitMs_ > 0) {
+            pns.setDeadline(startTime_ + std::chrono::milliseconds(hardLimitMs_ / 2));
+        }
+        Coord move;
+        ProofOutcome outcome = pns.solve(playerToCell(player_), move);
+        stats_.proofNodes += pns.nodes();
+        stats_.proofOutcome = outcome;
+        if (move.row() < 0) return false;
+        if (outcome == ProofOutcome::Win) {
+            out = MoveEvaluation(move, WIN_SCORE + emptyCells);
+            return true;
+        }
+        if (outcome == ProofOutcome::Draw) {
+            out = MoveEvaluation(move, 0);
+            return true;
+        }
+        return false;
+    }
+
+    // Scored like a full board in evaluateHeuristicLines: final differential * 1000.
+    bool solveLinesEndgame(const Board& board, int scoreX, int scoreO, MoveEvaluation& out) {
+        LinesEndgameSolver solver(board);
+        if (!solver.applicable()) return false;
+        solver.setCancelFlag(cancelFlag_);
+        solver.setNodeBudget(endgameNodeBudget_);
+        if (hardLimitMs_ > 0) {
+            solver.setDeadline(startTime_ + std::chrono::milliseconds(hardLimitMs_ * 3 / 4));
+        }
+        int futureDiff = 0;
+        Coord move;
+        bool solved = solver.solve(playerToCell(player_), futureDiff, move);
+        stats_.endgameNodes += solver.nodes();
+        if (!solved) return false;
+        stats_.endgameExact = true;
+        int64_t finalDiff = static_cast<int64_t>(baseScorePerspective(scoreX, scoreO)) + futureDiff;
+        out = MoveEvaluation(move, clampScore(finalDiff * 1000));
+        return true;
     }
 
     void updateBestSoFar(const MoveEvaluation& candidate) {
@@ -1216,22 +2423,337 @@ private:
         }
     }
 
+    // MCTS state shared by the threads of one search. Iterations take a ticket
+    // from issued, so a playout budget is exact whatever the thread count.
+    class MctsShared {
+    public:
+        MctsTree* tree = nullptr;
+        uint64_t budget = 0;
+        long long limitMs = -1;
+        int scoreX = 0;
+        int scoreO = 0;
+        std::atomic<uint64_t> issued{ 0 };
+        std::atomic<bool> stop{ false };
+    };
+
+    class MctsWorkerResult {
+    public:
+        uint64_t iterations = 0;
+        uint64_t playouts = 0;
+        uint64_t playoutMoves = 0;
+        int maxDepth = 0;
+    };
+
+    static constexpr int MCTS_SCORE_SCALE = 1000;
+
+    static int mctsScore(const MctsNode& node) {
+        return static_cast<int>(std::lround((node.value() * 2.0 - 1.0) * MCTS_SCORE_SCALE));
+    }
+
+    // X's points for an outcome as MctsPlayout::run reports it. A LinesScore
+    // differential goes through a logistic of one line, so the margin counts too.
+    int64_t mctsPoints(int outcome) const {
+        if (mode_ == GameMode::Classic) return static_cast<int64_t>(outcome + 1) * (MctsNode::WIN / 2);
+        return static_cast<int64_t>(MctsNode::WIN / (1.0 + std::exp(-static_cast<double>(outcome))));
+    }
+
+    // Classic leaves blend the playout with the static eval in win-probability
+    // form, one unit being the weight of a window a stone short of a line. The
+    // pattern table is built from the window weights and shares that scale; the
+    // network's output has none, so under it the leaf reads the window counter.
+    int64_t mctsLeafPoints(const Board& board, int outcome, int scoreX, int scoreO) const {
+        int64_t points = mctsPoints(outcome);
+        if (mode_ != GameMode::Classic) return points;
+        double eval = neuralActive_ ? clampScore(windowScoreSum_ + centerBias_) : evaluateHeuristic(board, scoreX, scoreO);
+        if (player_ == Player::O) eval = -eval;
+        double scale = static_cast<double>(std::max(1, windowWeight_[evalWinLen_ - 1]));
+        double evalPoints = MctsNode::WIN / (1.0 + std::exp(-eval / scale));
+        return static_cast<int64_t>((1.0 - MCTS_EVAL_WEIGHT) * points + MCTS_EVAL_WEIGHT * evalPoints);
+    }
+
+    // Softmax over moveUrgency plus the eval swing of the cell for either side, in
+    // units of a window one stone short of a line. Reads the incremental window
+    // maps whatever the backend, so they must describe board.
+    void mctsPriors(const Board& board, const DynamicArray<Coord>& moves, const DynamicArray<Coord>& mustPlay,
+                    Player side, DynamicArray<double>& priors) const {
+        CellState own = playerToCell(side);
+        CellState opp = playerToCell(getOpponent(side));
+        double scale = static_cast<double>(std::max(1, windowWeight_[evalWinLen_ - 1]));
+        double top = -std::numeric_limits<double>::infinity();
+        priors.clear();
+        for (size_t i = 0; i < moves.size(); ++i) {
+            double logit = moveUrgency(board, moves[i], true, side, MAX_KILLER_DEPTH, Coord(-1, -1), mustPlay) +
+                           static_cast<double>(cellSwing(moves[i], own)) + static_cast<double>(cellSwing(moves[i], opp)) / 2.0;
+            logit /= scale;
+            priors.push_back(logit);
+            if (logit > top) top = logit;
+        }
+        double sum = 0.0;
+        for (size_t i = 0; i < priors.size(); ++i) {
+            priors[i] = std::exp(priors[i] - top);
+            sum += priors[i];
+        }
+        for (size_t i = 0; i < priors.size(); ++i) priors[i] /= sum;
+    }
+
+    // Publishes the children of nodeIdx, highest priors first; false when the pool
+    // is full. The caller owns the node's Expanding state.
+    bool mctsExpand(MctsTree& tree, int nodeIdx, const Board& board, const DynamicArray<Coord>& moves,
+                    const DynamicArray<Coord>& mustPlay, Player side) {
+        DynamicArray<double> priors;
+        mctsPriors(board, moves, mustPlay, side, priors);
+        DynamicArray<std::pair<double,int>> order;
+        order.reserve(moves.size());
+        for (size_t i = 0; i < moves.size(); ++i) order.push_back(std::pair<double,int>(priors[i], static_cast<int>(i)));
+        std::sort(order.begin(), order.end(), [](const std::pair<double,int>& a, const std::pair<double,int>& b) {
+            return a.first > b.first;
+        });
+        int count = static_cast<int>(std::min(order.size(), static_cast<size_t>(MCTS_MAX_CHILDREN)));
+        int first = (count > 0) ? tree.allocate(count) : -1;
+        if (count > 0 && first < 0) return false;
+        double kept = 0.0;
+        for (int i = 0; i < count; ++i) kept += order[i].first;
+        int cols = board.getCols();
+        for (int i = 0; i < count; ++i) {
+            MctsNode& child = tree.node(first + i);
+            const Coord& mv = moves[order[i].second];
+            child.cell = mv.row() * cols + mv.col();
+            child.prior = static_cast<float>(kept > 0.0 ? order[i].first / kept : 1.0 / count);
+        }
+        MctsNode& node = tree.node(nodeIdx);
+        node.firstChild = first;
+        node.childCount = count;
+        node.state.store(MctsNode::Expanded, std::memory_order_release);
+        return true;
+    }
+
+    bool mctsShouldStop(const MctsShared& shared) const {
+        if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) return true;
+        return shared.limitMs > 0 && elapsedSinceStartMs() >= shared.limitMs;
+    }
+
+    // One thread of the search: select by PUCT down the shared tree (applying the
+    // moves to board and the eval maps), expand the leaf, play it out, back up.
+    MctsWorkerResult mctsRun(MctsShared& shared, Board& board, uint64_t seed) {
+        MctsTree& tree = *shared.tree;
+        int cols = board.getCols();
+        int total = board.getRows() * cols;
+        MctsPlayout playout(board.getRows(), cols, board.getWinLength(), mode_);
+        MctsWorkerResult out;
+        uint64_t rng = seed | 1;
+        DynamicArray<int> path;
+        DynamicArray<Coord> applied;
+        DynamicArray<Coord> mustPlay;
+        while (!shared.stop.load(std::memory_order_relaxed)) {
+            if ((out.iterations & 63) == 0 && mctsShouldStop(shared)) {
+                shared.stop.store(true, std::memory_order_relaxed);
+                break;
+            }
+            uint64_t ticket = shared.issued.fetch_add(1, std::memory_order_relaxed);
+            if (shared.budget > 0 && ticket >= shared.budget) break;
+            ++out.iterations;
+
+            path.clear();
+            applied.clear();
+            int nodeIdx = 0;
+            Player side = player_;
+            int credit[2] = { shared.scoreX, shared.scoreO };
+            int64_t points = -1;
+            path.push_back(0);
+            tree.node(0).virtualLoss.fetch_add(1, std::memory_order_relaxed);
+            while (true) {
+                MctsNode& node = tree.node(nodeIdx);
+                if (node.state.load(std::memory_order_acquire) != MctsNode::Expanded) break;
+                if (node.childCount == 0) {
+                    points = mctsPoints(mode_ == GameMode::Classic ? 0 : credit[0] - credit[1]);
+                    break;
+                }
+                int childIdx = tree.select(nodeIdx, MCTS_CPUCT, MCTS_FPU_REDUCTION);
+                MctsNode& child = tree.node(childIdx);
+                child.virtualLoss.fetch_add(1, std::memory_order_relaxed);
+                path.push_back(childIdx);
+                Coord mv(child.cell / cols, child.cell % cols);
+                int gained = applyMoveEval(board, mv, playerToCell(side));
+                applied.push_back(mv);
+                if (gained > 0 && mode_ == GameMode::Classic) {
+                    points = mctsPoints(side == Player::X ? 1 : -1);
+                    break;
+                }
+                if (mode_ == GameMode::LinesScore) credit[side == Player::X ? 0 : 1] += std::min(2, std::max(0, gained));
+                side = getOpponent(side);
+                nodeIdx = childIdx;
+                if (board.isFull()) {
+                    points = mctsPoints(mode_ == GameMode::Classic ? 0 : credit[0] - credit[1]);
+                    break;
+                }
+            }
+            out.maxDepth = std::max(out.maxDepth, static_cast<int>(path.size()) - 1);
+
+            if (points < 0) {
+                MctsNode& leaf = tree.node(nodeIdx);
+                int expected = MctsNode::Leaf;
+                if (leaf.visits.load(std::memory_order_relaxed) + 1 >= MCTS_EXPAND_VISITS &&
+                    leaf.state.compare_exchange_strong(expected, MctsNode::Expanding)) {
+                    mustPlay.clear();
+                    DynamicArray<Coord> moves = getSearchMoves(board, 3, side, &mustPlay);
+                    if (!mctsExpand(tree, nodeIdx, board, moves, mustPlay, side)) {
+                        leaf.state.store(MctsNode::Leaf, std::memory_order_release);
+                    }
+                }
+                playout.load(board);
+                for (int idx = 0; idx < total; ++idx) {
+                    if (cellGain_[0].unchecked(static_cast<size_t>(idx)) > 0) playout.addLineCell(CellState::X, idx);
+                    if (cellGain_[1].unchecked(static_cast<size_t>(idx)) > 0) playout.addLineCell(CellState::O, idx);
+                }
+                int outcome = playout.run(playerToCell(side), credit[0], credit[1], rng, out.playoutMoves);
+                points = mctsLeafPoints(board, outcome, credit[0], credit[1]);
+                ++out.playouts;
+            }
+
+            // path[i] holds the move of player_ for odd i, of the opponent for even i.
+            for (size_t i = 0; i < path.size(); ++i) {
+                MctsNode& node = tree.node(path[i]);
+                Player mover = (i % 2 == 1) ? player_ : opponent_;
+                node.points.fetch_add(mover == Player::X ? points : MctsNode::WIN - points, std::memory_order_relaxed);
+                node.visits.fetch_add(1, std::memory_order_relaxed);
+                node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+            }
+            for (size_t i = applied.size(); i-- > 0;) {
+                undoMoveEval(board, applied[i], board.getNoCheck(applied[i].row(), applied[i].col()));
+            }
+
+            if (bestSoFarPtr_ && (out.iterations & 255) == 0) {
+                int best = tree.bestChild(0);
+                if (best >= 0) {
+                    const MctsNode& node = tree.node(best);
+                    *bestSoFarPtr_ = MoveEvaluation(Coord(node.cell / cols, node.cell % cols), mctsScore(node));
+                }
+            }
+        }
+        return out;
+    }
+
+    // Monte Carlo tree search from the root moves the caller generated (opening
+    // filters applied); the incremental maps must describe board. The budget is the
+    // node limit, else the time limit, else maxDepth_ * MCTS_PLAYOUTS_PER_DEPTH
+    // playouts. rootScores, when given, gets every root move, most visited first.
+    MoveEvaluation mctsSearch(Board& board, const DynamicArray<Coord>& rootMoves, const DynamicArray<Coord>& mustPlay,
+                              int scoreX, int scoreO, DynamicArray<std::pair<Coord,int>>* rootScores = nullptr) {
+        MctsShared shared;
+        shared.scoreX = scoreX;
+        shared.scoreO = scoreO;
+        shared.budget = nodeLimit_;
+        if (hardLimitMs_ > 0) {
+            shared.limitMs = hardLimitMs_;
+            if (timeManager_.softLimitMs() > 0) {
+                shared.limitMs = std::min<long long>(shared.limitMs, 2LL * timeManager_.softLimitMs());
+            }
+        }
+        if (shared.budget == 0 && shared.limitMs <= 0) {
+            shared.budget = static_cast<uint64_t>(std::max(1, maxDepth_)) * MCTS_PLAYOUTS_PER_DEPTH;
+        }
+        size_t capacity = MctsTree::MAX_NODES;
+        if (shared.budget > 0) {
+            uint64_t expansions = shared.budget / MCTS_EXPAND_VISITS + 1;
+            capacity = static_cast<size_t>(std::min<uint64_t>(capacity, 1 + rootMoves.size() + expansions * MCTS_MAX_CHILDREN));
+        }
+        MctsTree tree(capacity);
+        shared.tree = &tree;
+        tree.node(0).state.store(MctsNode::Expanding, std::memory_order_relaxed);
+        mctsExpand(tree, 0, board, rootMoves, mustPlay, player_);
+
+        unsigned int threads = deterministic_
+            ? 1u
+            : CpuQuota::resolveThreadBudget(threadBudget_, CpuQuota::effectiveCpus());
+        uint64_t seed = mixSignature(computeZobrist(board, player_),
+                                     static_cast<uint64_t>(static_cast<uint32_t>(scoreX)) << 32 | static_cast<uint32_t>(scoreO));
+        auto runWorker = [&](unsigned int t) {
+            Board local = board;
+            MinimaxAI worker(player_, maxDepth_, false, mode_, cancelFlag_, t == 0 ? bestSoFarPtr_ : nullptr);
+            worker.startTime_ = startTime_;
+            worker.moveGenMode_ = moveGenMode_;
+            worker.classicMustPlay_ = classicMustPlay_;
+            worker.dropDeadCells_ = dropDeadCells_;
+            worker.useLineBounds_ = useLineBounds_;
+            worker.perfectClassic3_ = perfectClassic3_;
+            worker.evalBackend_ = evalBackend_;
+            worker.neuralNet_ = neuralNet_;
+            worker.evalWeights_ = evalWeights_;
+            worker.initEvalCache(local);
+            return worker.mctsRun(shared, local, mixSignature(seed, t));
+        };
+        DynamicArray<std::future<MctsWorkerResult>> futures;
+        for (unsigned int t = 1; t < threads; ++t) {
+            futures.push_back(std::async(std::launch::async, runWorker, t));
+        }
+        MctsWorkerResult total = runWorker(0);
+        for (auto& f : futures) {
+            MctsWorkerResult r = f.get();
+            total.iterations += r.iterations;
+            total.playouts += r.playouts;
+            total.playoutMoves += r.playoutMoves;
+            total.maxDepth = std::max(total.maxDepth, r.maxDepth);
+        }
+
+        if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) {
+            markStopped();
+        } else if (shared.limitMs > 0 && elapsedSinceStartMs() >= shared.limitMs) {
+            stopped_ = true;
+            stopReferenceMs_ = shared.limitMs;
+        }
+        stats_.nodes += total.iterations;
+        stats_.nodesVisited += total.playoutMoves;
+        stats_.mctsPlayouts += total.playouts;
+        stats_.mctsTreeNodes = tree.used();
+        stats_.completedDepth = total.maxDepth;
+
+        int cols = board.getCols();
+        const MctsNode& root = tree.node(0);
+        if (rootScores) {
+            DynamicArray<std::pair<int,int>> byVisits;
+            for (int i = 0; i < root.childCount; ++i) {
+                byVisits.push_back(std::pair<int,int>(tree.node(root.firstChild + i).visits.load(), root.firstChild + i));
+            }
+            std::sort(byVisits.begin(), byVisits.end(), [](const std::pair<int,int>& a, const std::pair<int,int>& b) {
+                return a.first > b.first;
+            });
+            rootScores->clear();
+            for (size_t i = 0; i < byVisits.size(); ++i) {
+                const MctsNode& node = tree.node(byVisits[i].second);
+                rootScores->push_back(std::pair<Coord,int>(Coord(node.cell / cols, node.cell % cols), mctsScore(node)));
+            }
+        }
+        int best = tree.bestChild(0);
+        if (best < 0) return MoveEvaluation();
+        const MctsNode& node = tree.node(best);
+        MoveEvaluation result(Coord(node.cell / cols, node.cell % cols), mctsScore(node));
+        if (bestSoFarPtr_) *bestSoFarPtr_ = result;
+        return result;
+    }
+
 public:
-    MinimaxAI(Player player, int maxDepth = 9, bool useMemoization = true, GameMode mode = GameMode::Classic, std::atomic<bool>* cancelFlag = nullptr, MoveEvaluation* bestSoFar = nullptr, DynamicArray<int>* historyTable = nullptr)
+    MinimaxAI(Player player, int maxDepth = 9, bool useMemoization = true, GameMode mode = GameMode::Classic, std::atomic<bool>* cancelFlag = nullptr, MoveEvaluation* bestSoFar = nullptr)
         : player_(player),
         opponent_(getOpponent(player)),
         maxDepth_(maxDepth),
         useMemoization_(useMemoization),
         mode_(mode),
         cancelFlag_(cancelFlag),
-        bestSoFarPtr_(bestSoFar),
-        historyTable_(historyTable)
+        bestSoFarPtr_(bestSoFar)
     {}
 
     MoveEvaluation findBestMove(Board& board) {
         stats_.reset();
         startTime_ = std::chrono::steady_clock::now();
+        resetSearchControl();
+        if (deterministic_) {
+            transpositionTable_.clear();
+            carryTTGeneration_ = false;
+        }
+        uint64_t prevGeneration = ttGeneration_;
         ++ttGeneration_;
+        ttMinValidGeneration_ = carryTTGeneration_ ? prevGeneration : ttGeneration_;
+        carryTTGeneration_ = false;
         int rows = board.getRows();
         int cols = board.getCols();
         int winLen = board.getWinLength();
@@ -1245,8 +2767,17 @@ public:
                 transpositionTable_.clear();
             }
             ttGeneration_ = 1;
+            ttMinValidGeneration_ = 1;
         }
         int totalCells = rows * cols;
+        int filledCells = countFilledCapped(board, totalCells);
+        // Root move generation reads the incremental maps, so they must describe this board.
+        initEvalCache(board);
+        timeManager_.startMove(gameTimeMs_, incrementMs_, filledCells, totalCells - filledCells, timeLimitMs_);
+        hardLimitMs_ = timeManager_.hardLimitMs();
+        if (deterministic_) {
+            hardLimitMs_ = -1;
+        }
 
         int searchDepth = maxDepth_;
         if (mode_ == GameMode::Classic && rows == 3 && cols == 3 && perfectClassic3_) {
@@ -1328,10 +2859,8 @@ public:
             return MoveEvaluation();
         }
 
-        DynamicArray<int> history;
-        history.reserve(static_cast<size_t>(rows * cols));
-        for (int i = 0; i < rows * cols; ++i) history.push_back(0);
-        historyTable_ = &history;
+        prepareHistory(rows, cols);
+        DynamicArray<int>& history = history_[player_ == Player::X ? 0 : 1];
         for (int d = 0; d < MAX_KILLER_DEPTH; ++d) {
             killerMoves_[d][0] = Coord(-1, -1);
             killerMoves_[d][1] = Coord(-1, -1);
@@ -1350,6 +2879,62 @@ public:
             bestSoFarPtr_->move = Coord(-1, -1);
         }
 
+        int emptyCells = totalCells - filledCells;
+        if (mode_ == GameMode::Classic && proofThreshold_ > 0 && emptyCells <= proofThreshold_ && !emptyBoard) {
+            MoveEvaluation exact;
+            if (solveExactly(board, emptyCells, exact)) {
+                updateBestSoFar(exact);
+                stats_.completedDepth = searchDepth;
+                stats_.timeMs = elapsedSinceStartMs();
+                stats_.elapsedMs = static_cast<double>(stats_.timeMs);
+                stats_.searchSignature = searchSignature(stats_.proofNodes, exact.move, stats_.completedDepth);
+                return exact;
+            }
+        }
+
+        if (mode_ == GameMode::LinesScore && endgameThreshold_ > 0 && emptyCells <= endgameThreshold_ && !emptyBoard) {
+            MoveEvaluation exact;
+            if (solveLinesEndgame(board, baseScoreX, baseScoreO, exact)) {
+                updateBestSoFar(exact);
+                stats_.completedDepth = emptyCells;
+                stats_.timeMs = elapsedSinceStartMs();
+                stats_.elapsedMs = static_cast<double>(stats_.timeMs);
+                stats_.searchSignature = searchSignature(stats_.endgameNodes, exact.move, stats_.completedDepth);
+                return exact;
+            }
+        }
+
+        Coord threatHint(-1, -1);
+        if (useThreatSearch_ && mode_ == GameMode::Classic && winLen >= 4 && !emptyBoard) {
+            MoveEvaluation forced;
+            if (solveThreats(board, forced, threatHint)) {
+                if (useMemoization_) {
+                    TTEntry entry;
+                    entry.score = forced.score;
+                    entry.depth = searchDepth;
+                    entry.flag = TTEntry::Flag::Lower;
+                    entry.bestMove = forced;
+                    entry.generation = ttGeneration_;
+                    transpositionTable_.insert(makeHashKey(baseHash, rows, cols, winLen, baseScoreX, baseScoreO), entry);
+                }
+                updateBestSoFar(forced);
+                stats_.completedDepth = searchDepth;
+                stats_.timeMs = elapsedSinceStartMs();
+                stats_.elapsedMs = static_cast<double>(stats_.timeMs);
+                stats_.searchSignature = searchSignature(stats_.threatNodes, forced.move, stats_.completedDepth);
+                return forced;
+            }
+        }
+
+        if (searchEngine_ == SearchEngine::Mcts) {
+            MoveEvaluation result = mctsSearch(board, moves, mustPlay, baseScoreX, baseScoreO);
+            stats_.timeMs = elapsedSinceStartMs();
+            stats_.elapsedMs = static_cast<double>(stats_.timeMs);
+            finishSearchControl();
+            stats_.searchSignature = searchSignature(stats_.nodes, result.move, stats_.completedDepth);
+            return result;
+        }
+
         auto isMustPlayMove = [&](const Coord& mv) -> bool {
             for (size_t i = 0; i < mustPlay.size(); ++i) {
                 if (mustPlay[i] == mv) return true;
@@ -1378,6 +2963,9 @@ public:
             if (!mustPlay.empty() && isMustPlayMove(mv)) {
                 bonus += 20000;
             }
+            if (mv == threatHint) {
+                bonus += 5000;
+            }
             int hist = 0;
             int idx = mv.row() * cols + mv.col();
             if (idx >= 0 && idx < static_cast<int>(history.size())) hist = history[idx];
@@ -1390,13 +2978,21 @@ public:
 
         MoveEvaluation principal;
         principal.score = std::numeric_limits<int>::min();
-        unsigned int hw = std::thread::hardware_concurrency();
+        // Last completed score per depth parity: scores alternate with the side
+        // that moves last, so MTD(f) starts from the one two plies back.
+        int parityScores[2] = { std::numeric_limits<int>::min(), std::numeric_limits<int>::min() };
+        unsigned int threadBudget = deterministic_
+            ? CpuQuota::resolveThreadBudget(threadBudget_, CpuQuota::DEFAULT_THREAD_CAP)
+            : CpuQuota::resolveThreadBudget(threadBudget_, CpuQuota::effectiveCpus());
         // HOTFIX: keep LinesScore single-threaded to avoid rare crashes in AI vs AI.
         bool enableParallel = (mode_ == GameMode::Classic) &&
-                              (moves.size() > 2 && searchDepth >= 4 && hw > 1);
-        unsigned int threadBudget = hw == 0 ? 2 : std::min<unsigned int>(hw, 4);
+                              (moves.size() > 2 && searchDepth >= 4 && threadBudget > 1);
 
         for (int depth = 1; depth <= searchDepth; ++depth) {
+            if (iterationNodeBudget_ > 0) {
+                uint64_t cap = stats_.nodes + iterationNodeBudget_;
+                activeNodeLimit_ = (nodeLimit_ > 0) ? std::min(nodeLimit_, cap) : cap;
+            }
             orderMoves(moves, principal);
             int extensionBudget = (useExtensions_ && mode_ == GameMode::LinesScore)
                 ? std::min(1, depth / 2)
@@ -1418,11 +3014,10 @@ public:
                 aspBeta  = principal.score + baseWindow;
             }
 
-            do {
-                redoFullWindow = false;
-                int alpha = aspAlpha;
-                int beta  = aspBeta;
-
+            // One pass over the root moves. An MTD(f) probe stops at the first move
+            // that fails high and publishes only such moves: below beta the scores
+            // are mere upper bounds.
+            auto searchRoot = [&](int alpha, int beta, bool probe) -> MoveEvaluation {
                 MoveEvaluation bestAtDepth;
                 bestAtDepth.score = std::numeric_limits<int>::min();
 
@@ -1432,34 +3027,61 @@ public:
                         Coord mv;
                         int score;
                         AIStatistics stats;
+                        bool stopped;
+                        long long stopReferenceMs;
                     };
                     Board rootSnapshot = board;
                     size_t idxMove = 0;
                     while (idxMove < moves.size() && !isCancelled()) {
                         DynamicArray<std::future<TaskResult>> futures;
                         futures.reserve(threadBudget);
+                        uint64_t workerNodeLimit = 0;
+                        if (activeNodeLimit_ > 0) {
+                            uint64_t left = activeNodeLimit_ > stats_.nodes ? activeNodeLimit_ - stats_.nodes : 1;
+                            workerNodeLimit = std::max<uint64_t>(1, left / threadBudget);
+                        }
                         for (unsigned int t = 0; t < threadBudget && idxMove < moves.size(); ++t, ++idxMove) {
                             Coord mv = moves[idxMove];
                             futures.push_back(std::async(std::launch::async, [=]() mutable {
                                 Board localBoard = rootSnapshot;
-                                MinimaxAI worker(player_, searchDepth, useMemoization_, mode_, cancelFlag_, nullptr, nullptr);
+                                MinimaxAI worker(player_, searchDepth, useMemoization_, mode_, cancelFlag_, nullptr);
                                 worker.timeLimitMs_ = timeLimitMs_;
+                                worker.hardLimitMs_ = hardLimitMs_;
                                 worker.startTime_ = startTime_;
+                                worker.clockPollInterval_ = clockPollInterval_;
+                                worker.nodeLimit_ = workerNodeLimit;
                                 worker.moveGenMode_ = moveGenMode_;
                                 worker.useLMR_ = useLMR_;
                                 worker.enableLMRLines_ = enableLMRLines_;
                                 worker.useExtensions_ = useExtensions_;
                                 worker.perfectClassic3_ = perfectClassic3_;
+                                worker.useLineBounds_ = useLineBounds_;
+                                worker.dropDeadCells_ = dropDeadCells_;
+                                worker.classicMustPlay_ = classicMustPlay_;
+                                worker.useQuiescence_ = useQuiescence_;
+                                worker.useNullMove_ = useNullMove_;
+                                worker.useProbCut_ = useProbCut_;
+                                worker.useShallowPruning_ = useShallowPruning_;
+                                worker.useEvalCache_ = useEvalCache_;
+                                worker.evalBackend_ = evalBackend_;
+                                worker.neuralNet_ = neuralNet_;
+                                worker.evalWeights_ = evalWeights_;
+                                // Fresh for every task: nothing would be revisited.
+                                worker.useOrderCache_ = false;
+                                worker.quiescencePlyCap_ = quiescencePlyCap_;
+                                worker.quiescenceNodeCap_ = quiescenceNodeCap_;
                                 for (int d = 0; d < MAX_KILLER_DEPTH; ++d) {
                                     worker.killerMoves_[d][0] = Coord(-1, -1);
                                     worker.killerMoves_[d][1] = Coord(-1, -1);
                                 }
                                 worker.initZobrist(rows, cols);
                                 worker.initEvalCache(localBoard);
-                                DynamicArray<int> localHistory;
-                                localHistory.reserve(static_cast<size_t>(rows * cols));
-                                for (int j = 0; j < rows * cols; ++j) localHistory.push_back(0);
-                                worker.historyTable_ = &localHistory;
+                                for (int side = 0; side < 2; ++side) {
+                                    worker.history_[side] = history_[side];
+                                    worker.counterMoves_[side] = counterMoves_[side];
+                                    worker.followUps_[side] = followUps_[side];
+                                }
+                                worker.historyCols_ = historyCols_;
 
                                 int gained = worker.applyMoveEval(localBoard, mv, playerCell);
                                 uint64_t childHash = baseHash;
@@ -1476,13 +3098,19 @@ public:
                                 }
                                 int sc = worker.minimax(localBoard, depth - 1, alpha, beta,
                                                         worker.opponent_, false, childHash, mv, nextScoreX, nextScoreO, extensionBudget);
-                                TaskResult r{ mv, sc, worker.stats_ };
+                                worker.stats_.clockPolls = worker.clockPolls_;
+                                TaskResult r{ mv, sc, worker.stats_, worker.stopped_, worker.stopReferenceMs_ };
                                 return r;
                             }));
                         }
                         bool cutoff = false;
                         for (auto& f : futures) {
                             TaskResult r = f.get();
+                            clockPolls_ += r.stats.clockPolls;
+                            if (r.stopped && !stopped_) {
+                                stopped_ = true;
+                                stopReferenceMs_ = r.stopReferenceMs;
+                            }
                             if (cutoff || isCancelled()) {
                                 continue;
                             }
@@ -1496,16 +3124,33 @@ public:
                             stats_.ttCutoffs     += r.stats.ttCutoffs;
                             stats_.generatedMoves += r.stats.generatedMoves;
                             stats_.expandedMoves += r.stats.expandedMoves;
+                            stats_.boundCutoffs  += r.stats.boundCutoffs;
+                            stats_.deadDrawCutoffs += r.stats.deadDrawCutoffs;
+                            stats_.deadCellsPruned += r.stats.deadCellsPruned;
+                            stats_.forcedMoveNodes += r.stats.forcedMoveNodes;
+                            stats_.quiescenceNodes += r.stats.quiescenceNodes;
+                            stats_.nullMoveTries += r.stats.nullMoveTries;
+                            stats_.nullMoveCutoffs += r.stats.nullMoveCutoffs;
+                            stats_.probCutTries += r.stats.probCutTries;
+                            stats_.probCutCutoffs += r.stats.probCutCutoffs;
+                            stats_.stagedCutoffs += r.stats.stagedCutoffs;
+                            stats_.orderCacheHits += r.stats.orderCacheHits;
+                            stats_.orderCacheMisses += r.stats.orderCacheMisses;
+                            stats_.evalCacheHits += r.stats.evalCacheHits;
+                            stats_.evalCacheMisses += r.stats.evalCacheMisses;
+                            for (int d = 0; d < 4; ++d) {
+                                stats_.futilityPruned[d] += r.stats.futilityPruned[d];
+                                stats_.lateMovePruned[d] += r.stats.lateMovePruned[d];
+                            }
                             if (r.score > bestAtDepth.score) {
                                 bestAtDepth.score = r.score;
                                 bestAtDepth.move  = r.mv;
-                                principal = bestAtDepth;
-                                updateBestSoFar(bestAtDepth);
-                            }
-                            int hidx = r.mv.row() * cols + r.mv.col();
-                            if (hidx >= 0 && hidx < static_cast<int>(history.size())) {
-                                history[hidx] += depth * depth;
+                                if (!probe || r.score >= beta) {
+                                    principal = bestAtDepth;
+                                    updateBestSoFar(bestAtDepth);
+                                }
                             }
+                            addHistory(player_, r.mv, depth * depth);
                             alpha = std::max(alpha, r.score);
                             if (alpha >= beta) {
                                 cutoff = true;
@@ -1538,39 +3183,87 @@ public:
                         if (score > bestAtDepth.score) {
                             bestAtDepth.score = score;
                             bestAtDepth.move  = moves[i];
-                            principal = bestAtDepth;
-                            updateBestSoFar(bestAtDepth);
+                            if (!probe || score >= beta) {
+                                principal = bestAtDepth;
+                                updateBestSoFar(bestAtDepth);
+                            }
                         }
 
-                        int idx = moves[i].row() * cols + moves[i].col();
-                        if (idx >= 0 && idx < static_cast<int>(history.size())) {
-                            history[idx] += depth * depth;
-                        }
+                        addHistory(player_, moves[i], depth * depth);
 
                         alpha = std::max(alpha, score);
 
-                        if (isCancelled()) {
+                        if (isCancelled() || (probe && alpha >= beta)) {
                             break;
                         }
                     }
                 }
 
-                if ((bestAtDepth.score <= aspAlpha || bestAtDepth.score >= aspBeta) &&
-                    (aspAlpha != fullAlpha || aspBeta != fullBeta)) {
-                    
-                    aspAlpha = fullAlpha;
-                    aspBeta  = fullBeta;
-                    redoFullWindow = true;
+                return bestAtDepth;
+            };
+
+            if (useMtdf_ && principal.score != std::numeric_limits<int>::min()) {
+                // MTD(f): zero-window probes converging on the score through the TT.
+                // The step doubles while probes keep failing the same way and the
+                // window is bisected once bracketed, so the wide LinesScore scale
+                // takes O(log) probes rather than one per fail-soft bound.
+                int64_t lower = std::numeric_limits<int>::min();
+                int64_t upper = std::numeric_limits<int>::max();
+                int64_t beta = principal.score;
+                if (parityScores[depth & 1] != std::numeric_limits<int>::min()) {
+                    beta = parityScores[depth & 1];
                 }
-
-                if (!isCancelled()) {
-                    bestMove = bestAtDepth;
+                int64_t step = 1;
+                int lastFail = 0;
+                MoveEvaluation found;
+                found.score = std::numeric_limits<int>::min();
+                while (lower < upper) {
+                    beta = std::max(lower + 1, std::min(upper, beta));
+                    MoveEvaluation probe = searchRoot(static_cast<int>(beta - 1), static_cast<int>(beta), true);
+                    if (isCancelled()) break;
+                    stats_.mtdfProbes++;
+                    if (probe.score >= beta) {
+                        lower = probe.score;
+                        found = probe;
+                        step = (lastFail > 0) ? step * 2 : 1;
+                        lastFail = 1;
+                        beta = lower + step;
+                    } else {
+                        upper = probe.score;
+                        step = (lastFail < 0) ? step * 2 : 1;
+                        lastFail = -1;
+                        beta = upper - step + 1;
+                    }
+                    if (lower != std::numeric_limits<int>::min() && upper != std::numeric_limits<int>::max()) {
+                        beta = lower + (upper - lower + 1) / 2;
+                    }
                 }
-
-                if (isCancelled()) {
-                    break;
+                if (!isCancelled() && found.score != std::numeric_limits<int>::min()) {
+                    bestMove = found;
+                    principal = found;
                 }
-            } while (redoFullWindow);
+            } else {
+                do {
+                    redoFullWindow = false;
+                    MoveEvaluation bestAtDepth = searchRoot(aspAlpha, aspBeta, false);
+
+                    if ((bestAtDepth.score <= aspAlpha || bestAtDepth.score >= aspBeta) &&
+                        (aspAlpha != fullAlpha || aspBeta != fullBeta)) {
+                    
+                        aspAlpha = fullAlpha;
+                        aspBeta  = fullBeta;
+                        redoFullWindow = true;
+                    }
+
+                    if (!isCancelled()) {
+                        bestMove = bestAtDepth;
+                    }
+
+                    if (isCancelled()) {
+                        break;
+                    }
+                } while (redoFullWindow);
+            }
 
             if (isCancelled()) {
                 break;
@@ -1578,13 +3271,24 @@ public:
 
             
             stats_.completedDepth = depth;
+            parityScores[depth & 1] = bestMove.score;
+
+            timeManager_.onIterationComplete(bestMove.move, bestMove.score, baseWindow);
+            if (depth < searchDepth && !deterministic_) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - startTime_).count();
+                if (!timeManager_.canStartIteration(elapsed)) {
+                    break;
+                }
+            }
         }
 
         auto endTime = std::chrono::steady_clock::now();
         stats_.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                             endTime - startTime_).count();
         stats_.elapsedMs = static_cast<double>(stats_.timeMs);
-        historyTable_ = nullptr;
+        finishSearchControl();
+        stats_.searchSignature = searchSignature(stats_.nodes, bestMove.move, stats_.completedDepth);
         return bestMove;
     }
 
@@ -1592,8 +3296,62 @@ public:
         return stats_;
     }
 
+    Coord predictReply(const Board& board, Player toMove, int scoreX, int scoreO) {
+        int rows = board.getRows();
+        int cols = board.getCols();
+        int winLen = board.getWinLength();
+        if (board.isFull()) return Coord(-1, -1);
+        if (zobristTable_.size() != static_cast<size_t>(rows * cols * 2)) {
+            initZobrist(rows, cols);
+        }
+        if (useMemoization_) {
+            size_t key = makeHashKey(computeZobrist(board, toMove), rows, cols, winLen, scoreX, scoreO);
+            if (transpositionTable_.contains(key)) {
+                const Coord& mv = transpositionTable_.get(key).bestMove.move;
+                if (mv.row() >= 0 && mv.col() >= 0 && mv.row() < rows && mv.col() < cols &&
+                    board.isEmpty(mv.row(), mv.col())) {
+                    return mv;
+                }
+            }
+        }
+
+        Board scratch = board;
+        initEvalCache(scratch);
+        DynamicArray<Coord> moves = getSearchMoves(scratch, 1, toMove);
+        CellState cell = playerToCell(toMove);
+        Coord best(-1, -1);
+        int64_t bestScore = std::numeric_limits<int64_t>::min();
+        for (size_t i = 0; i < moves.size(); ++i) {
+            int gained = applyMoveEval(scratch, moves[i], cell);
+            if (mode_ == GameMode::Classic && scratch.checkWinFromMove(moves[i], cell)) {
+                undoMoveEval(scratch, moves[i], cell);
+                return moves[i];
+            }
+            int sx = scoreX;
+            int so = scoreO;
+            if (mode_ == GameMode::LinesScore) {
+                int delta = std::min(2, std::max(0, gained));
+                if (cell == CellState::X) sx += delta;
+                else so += delta;
+            }
+            int64_t score = evaluateHeuristic(scratch, sx, so);
+            if (toMove != player_) score = -score;
+            undoMoveEval(scratch, moves[i], cell);
+            if (score > bestScore) {
+                bestScore = score;
+                best = moves[i];
+            }
+        }
+        return best;
+    }
+
+    void keepTranspositionsForNextSearch() { carryTTGeneration_ = true; }
+
     void clearCache() {
         transpositionTable_.clear();
+        orderCache_.clear();
+        evalCache_.clear();
+        historyCols_ = 0;
     }
 
     void setUseMemoization(bool use) {
@@ -1609,9 +3367,17 @@ public:
         opponent_ = getOpponent(p);
         clearCache();
     }
-    void setMode(GameMode m) { mode_ = m; }
+    void setMode(GameMode m) {
+        if (m != mode_) {
+            orderCache_.clear();
+            evalCache_.clear();
+        }
+        mode_ = m;
+    }
     void setCredits(int cx, int co) { creditedX_ = cx; creditedO_ = co; }
-    void setTimeLimitMs(int ms) { timeLimitMs_ = ms; }
+    void setTimeLimitMs(int ms) { timeLimitMs_ = ms; hardLimitMs_ = ms; }
+    void setGameClock(int remainingMs, int incrementMs) { gameTimeMs_ = remainingMs; incrementMs_ = incrementMs; }
+    const TimeManager& timeManager() const { return timeManager_; }
     void setMoveGenMode(MoveGenMode m) { moveGenMode_ = m; }
     void setUseLMR(bool v) { useLMR_ = v; }
     void setEnableLMRLines(bool v) { enableLMRLines_ = v; }
@@ -1619,6 +3385,144 @@ public:
     void setPerfectClassic3(bool v) { perfectClassic3_ = v; }
     void setBanCenterFirstMove(bool v) { banCenterFirstMove_ = v; }
     void setAllowOpeningShortcut(bool v) { allowOpeningShortcut_ = v; }
+    void setThreadBudget(int threads) { threadBudget_ = std::max(0, threads); }
+    void setNodeLimit(uint64_t nodes) { nodeLimit_ = nodes; }
+    uint64_t nodeLimit() const { return nodeLimit_; }
+    void setClockPollInterval(uint32_t calls) { clockPollInterval_ = std::max<uint32_t>(1, calls); }
+    // Deterministic mode ignores wall-clock limits, starts from an empty TT and uses a
+    // CPU-independent worker count, so node counts and moves repeat run to run.
+    void setDeterministic(bool v) { deterministic_ = v; }
+    bool deterministic() const { return deterministic_; }
+    void setIterationNodeBudget(uint64_t nodes) { iterationNodeBudget_ = nodes; }
+    void setUseThreatSearch(bool v) { useThreatSearch_ = v; }
+    bool useThreatSearch() const { return useThreatSearch_; }
+    void setThreatNodeBudget(uint64_t nodes) { threatNodeBudget_ = nodes; }
+    // Classic positions with at most this many empty cells go to the proof-number
+    // solver first; 0 disables it.
+    void setProofThreshold(int emptyCells) { proofThreshold_ = std::max(0, emptyCells); }
+    int proofThreshold() const { return proofThreshold_; }
+    void setProofNodeBudget(uint64_t nodes) { proofNodeBudget_ = nodes; }
+    // LinesScore positions with at most this many empty cells are solved exactly; 0 disables it.
+    void setEndgameThreshold(int emptyCells) {
+        endgameThreshold_ = std::max(0, std::min(emptyCells, LinesEndgameSolver::MAX_EMPTY));
+    }
+    int endgameThreshold() const { return endgameThreshold_; }
+    void setEndgameNodeBudget(uint64_t nodes) { endgameNodeBudget_ = nodes; }
+    // LinesScore: cut subtrees whose final-differential bounds (live windows per side)
+    // cannot reach the alpha-beta window, and clamp leaf evaluations into those bounds.
+    void setUseLineBounds(bool v) { useLineBounds_ = v; }
+    bool useLineBounds() const { return useLineBounds_; }
+    // Keep a single representative of the empty cells that lie in no open window.
+    void setDropDeadCells(bool v) { dropDeadCells_ = v; }
+    // Classic: generate only the winning move or the forced blocks when there are any.
+    void setClassicMustPlay(bool v) { classicMustPlay_ = v; }
+    // Quiescence at the horizon: plyCap bounds one line, nodeCap the whole search.
+    void setUseQuiescence(bool v) { useQuiescence_ = v; }
+    bool useQuiescence() const { return useQuiescence_; }
+    // Forward pruning, both off by default: null move with a verification search, and
+    // ProbCut from a search PROBCUT_REDUCTION plies shallower.
+    void setUseNullMove(bool v) { useNullMove_ = v; }
+    bool useNullMove() const { return useNullMove_; }
+    void setUseProbCut(bool v) { useProbCut_ = v; }
+    bool useProbCut() const { return useProbCut_; }
+    int historyScore(Player side, const Coord& mv) const {
+        int idx = historyIndex(mv);
+        return (idx >= 0) ? history_[side == Player::X ? 0 : 1][idx] : 0;
+    }
+    Coord counterMove(Player side, const Coord& lastMove) const { return counterMoveFor(side, lastMove); }
+    // Test hook: everything a MovePicker yields at a fresh node (order cache off),
+    // with the generated list, its must-play moves and the move cap.
+    DynamicArray<Coord> stagedOrder(Board& board, int depth, Player toMove, const Coord& ttHint,
+                                    DynamicArray<Coord>& generated, DynamicArray<Coord>& mustPlay, size_t& cap) {
+        initEvalCache(board);
+        bool orderCache = useOrderCache_;
+        useOrderCache_ = false;
+        MovePicker picker(*this, board, depth, toMove, ttHint, 0, Coord(-1, -1));
+        DynamicArray<Coord> order;
+        Coord mv;
+        int urgency = 0;
+        while (picker.next(mv, urgency)) order.push_back(mv);
+        useOrderCache_ = orderCache;
+        generated = picker.generatedMoves();
+        mustPlay = picker.mustPlayMoves();
+        cap = picker.cap();
+        return order;
+    }
+
+    // Test hooks for the incremental eval. evalMapsConsistent compares the per-cell
+    // maps with a full rebuild on a fresh engine, then checks every empty cell by a
+    // trial applyMoveEval/undoMoveEval (gain = lines completed, threat = change of
+    // the window sum) and that the trial leaves the state as it was.
+    void resetEval(const Board& board) { initEvalCache(board); }
+    int playEval(Board& board, const Coord& mv, CellState cell) { return applyMoveEval(board, mv, cell); }
+    void takeBackEval(Board& board, const Coord& mv, CellState cell) { undoMoveEval(board, mv, cell); }
+    bool evalMapsConsistent(Board& board) {
+        MinimaxAI fresh(player_, 1, false, mode_);
+        fresh.evalWeights_ = evalWeights_;
+        fresh.initEvalCache(board);
+        if (fresh.windowScoreSum_ != windowScoreSum_) return false;
+        int total = evalRows_ * evalCols_;
+        for (int idx = 0; idx < total; ++idx) {
+            if (fresh.cellOpenWindows_[idx] != cellOpenWindows_[idx]) return false;
+            for (int side = 0; side < 2; ++side) {
+                if (fresh.cellGain_[side][idx] != cellGain_[side][idx]) return false;
+                if (fresh.cellThreat_[side][idx] != cellThreat_[side][idx]) return false;
+            }
+        }
+        for (int idx = 0; idx < total; ++idx) {
+            Coord mv(idx / evalCols_, idx % evalCols_);
+            if (!board.isEmpty(mv)) continue;
+            for (int side = 0; side < 2; ++side) {
+                CellState cell = side == 0 ? CellState::X : CellState::O;
+                int gain = cellGain_[side][idx];
+                int64_t threat = cellThreat_[side][idx];
+                int64_t before = windowScoreSum_;
+                int gained = applyMoveEval(board, mv, cell);
+                int64_t delta = windowScoreSum_ - before;
+                undoMoveEval(board, mv, cell);
+                if (gained != gain || delta != threat || windowScoreSum_ != before) return false;
+                if (cellGain_[side][idx] != gain || cellThreat_[side][idx] != threat) return false;
+            }
+        }
+        return true;
+    }
+    void setUseEvalCache(bool v) { useEvalCache_ = v; }
+    bool useEvalCache() const { return useEvalCache_; }
+    // Stored scores come from the old evaluator, so switching drops the caches.
+    void setEvalBackend(EvalBackend b) {
+        if (b == evalBackend_) return;
+        evalBackend_ = b;
+        clearCache();
+    }
+    EvalBackend evalBackend() const { return evalBackend_; }
+    // Weights for EvalBackend::Neural; not owned, and must outlive the searches.
+    void setNeuralNet(const NeuralNet* net) {
+        if (net == neuralNet_) return;
+        neuralNet_ = net;
+        clearCache();
+    }
+    const NeuralNet* neuralNet() const { return neuralNet_; }
+    // Tuned window evaluator weights; not owned. The tables are rebuilt on the next search.
+    void setEvalWeights(const EvalWeightSet* weights) {
+        if (weights == evalWeights_) return;
+        evalWeights_ = weights;
+        evalReady_ = false;
+        clearCache();
+    }
+    const EvalWeightSet* evalWeights() const { return evalWeights_; }
+    void setSearchEngine(SearchEngine e) { searchEngine_ = e; }
+    SearchEngine searchEngine() const { return searchEngine_; }
+    void setUseMtdf(bool v) { useMtdf_ = v; }
+    bool useMtdf() const { return useMtdf_; }
+    void setUseOrderCache(bool v) { useOrderCache_ = v; }
+    bool useOrderCache() const { return useOrderCache_; }
+    // Futility and late-move pruning of quiet moves at depths 1-3.
+    void setUseShallowPruning(bool v) { useShallowPruning_ = v; }
+    bool useShallowPruning() const { return useShallowPruning_; }
+    void setQuiescenceLimits(int plyCap, uint64_t nodeCap) {
+        quiescencePlyCap_ = std::max(0, plyCap);
+        quiescenceNodeCap_ = nodeCap;
+    }
 };
 
 
@@ -1647,6 +3551,27 @@ public:
     void setEnableLMRLines(bool v) { enableLMRLines_ = v; }
     bool banCenterFirstMove() const { return banCenterFirstMove_; }
     void setBanCenterFirstMove(bool v) { banCenterFirstMove_ = v; }
+    int threadBudget() const { return threadBudget_; }
+    void setThreadBudget(int threads) { threadBudget_ = threads; }
+    int gameTimeMs() const { return gameTimeMs_; }
+    int incrementMs() const { return incrementMs_; }
+    void setGameClock(int remainingMs, int incrementMs) { gameTimeMs_ = remainingMs; incrementMs_ = incrementMs; }
+    uint64_t nodeLimit() const { return nodeLimit_; }
+    void setNodeLimit(uint64_t nodes) { nodeLimit_ = nodes; }
+    bool deterministic() const { return deterministic_; }
+    void setDeterministic(bool v) { deterministic_ = v; }
+    bool useNullMove() const { return useNullMove_; }
+    void setUseNullMove(bool v) { useNullMove_ = v; }
+    bool useProbCut() const { return useProbCut_; }
+    void setUseProbCut(bool v) { useProbCut_ = v; }
+    EvalBackend evalBackend() const { return evalBackend_; }
+    void setEvalBackend(EvalBackend b) { evalBackend_ = b; }
+    const NeuralNet* neuralNet() const { return neuralNet_; }
+    void setNeuralNet(const NeuralNet* net) { neuralNet_ = net; }
+    const EvalWeightSet* evalWeights() const { return evalWeights_; }
+    void setEvalWeights(const EvalWeightSet* weights) { evalWeights_ = weights; }
+    SearchEngine searchEngine() const { return searchEngine_; }
+    void setSearchEngine(SearchEngine e) { searchEngine_ = e; }
 
 private:
     int maxDepth_;
@@ -1658,6 +3583,17 @@ private:
     int timeLimitMs_ = -1;
     bool enableLMRLines_ = false;
     bool banCenterFirstMove_ = false;
+    int threadBudget_ = 0;
+    int gameTimeMs_ = -1;
+    int incrementMs_ = 0;
+    uint64_t nodeLimit_ = 0;
+    bool deterministic_ = false;
+    bool useNullMove_ = false;
+    bool useProbCut_ = false;
+    EvalBackend evalBackend_ = EvalBackend::Windows;
+    const NeuralNet* neuralNet_ = nullptr;
+    const EvalWeightSet* evalWeights_ = nullptr;
+    SearchEngine searchEngine_ = SearchEngine::AlphaBeta;
 };
 
 class AnalysisResult {
@@ -1671,25 +3607,44 @@ public:
 inline AnalysisResult analysePosition(const Board& b, Player toMove, GameMode mode, const SearchParams& params, int scoreX, int scoreO, std::atomic<bool>* cancelFlag)
 {
     Board boardCopy = b; 
-    MinimaxAI ai(toMove, params.maxDepth(), params.useMemoization(), mode, cancelFlag, nullptr, nullptr);
+    MinimaxAI ai(toMove, params.maxDepth(), params.useMemoization(), mode, cancelFlag, nullptr);
     ai.setMoveGenMode(params.moveGenMode());
     ai.setUseLMR(params.useLMR());
+    ai.setUseNullMove(params.useNullMove());
+    ai.setUseProbCut(params.useProbCut());
+    ai.setEvalBackend(params.evalBackend());
+    ai.setNeuralNet(params.neuralNet());
+    ai.setEvalWeights(params.evalWeights());
+    ai.setSearchEngine(params.searchEngine());
     ai.setUseExtensions(params.useExtensions());
     ai.setPerfectClassic3(params.perfectClassic3());
     ai.setTimeLimitMs(params.timeLimitMs());
     ai.setEnableLMRLines(params.enableLMRLines());
     ai.setBanCenterFirstMove(params.banCenterFirstMove());
+    ai.setThreadBudget(params.threadBudget());
+    ai.setNodeLimit(params.nodeLimit());
+    ai.setDeterministic(params.deterministic());
+    if (params.deterministic()) {
+        ai.setTimeLimitMs(-1);
+    } else if (params.gameTimeMs() > 0) {
+        int total = boardCopy.getRows() * boardCopy.getCols();
+        int filled = ai.countFilledCapped(boardCopy, total);
+        ai.timeManager_.startMove(params.gameTimeMs(), params.incrementMs(), filled, total - filled, params.timeLimitMs());
+        ai.hardLimitMs_ = ai.timeManager_.hardLimitMs();
+    }
     ai.initZobrist(boardCopy.getRows(), boardCopy.getCols());
     uint64_t baseHash = ai.computeZobrist(boardCopy, toMove);
     ai.initEvalCache(boardCopy);
     ai.startTime_ = std::chrono::steady_clock::now();
+    ai.resetSearchControl();
 
     AnalysisResult result;
     result.bestMove  = Move(-1, -1);
     result.bestScore = std::numeric_limits<int>::min();
     result.topMoves.clear();
 
-    DynamicArray<Coord> moves = ai.getSearchMoves(boardCopy, params.maxDepth(), toMove);
+    DynamicArray<Coord> mustPlay;
+    DynamicArray<Coord> moves = ai.getSearchMoves(boardCopy, params.maxDepth(), toMove, &mustPlay);
     int rows = boardCopy.getRows();
     int cols = boardCopy.getCols();
     bool emptyBoard = true;
@@ -1726,6 +3681,19 @@ inline AnalysisResult analysePosition(const Board& b, Player toMove, GameMode mo
     ai.stats_.reset();
     auto startTime = std::chrono::high_resolution_clock::now();
 
+    if (params.searchEngine() == SearchEngine::Mcts) {
+        MoveEvaluation best = ai.mctsSearch(boardCopy, moves, mustPlay, scoreX, scoreO, &result.topMoves);
+        result.bestMove = best.move;
+        result.bestScore = best.score;
+        ai.stats_.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::high_resolution_clock::now() - startTime).count();
+        ai.stats_.elapsedMs = static_cast<double>(ai.stats_.timeMs);
+        ai.finishSearchControl();
+        ai.stats_.searchSignature = MinimaxAI::searchSignature(ai.stats_.nodes, result.bestMove, ai.stats_.completedDepth);
+        result.stats = ai.stats_;
+        return result;
+    }
+
     int extensionBudget = (params.useExtensions() && mode == GameMode::LinesScore)
         ? std::min(1, params.maxDepth() / 2)
         : 0;
@@ -1777,6 +3745,8 @@ inline AnalysisResult analysePosition(const Board& b, Player toMove, GameMode mo
                            endTime - startTime).count();
     ai.stats_.elapsedMs = static_cast<double>(ai.stats_.timeMs);
     bool cancelled = ai.isCancelled();
+    ai.finishSearchControl();
+    ai.stats_.searchSignature = MinimaxAI::searchSignature(ai.stats_.nodes, result.bestMove, cancelled ? 0 : params.maxDepth());
     ai.stats_.completedDepth = cancelled ? 0 : params.maxDepth();
 
     
@@ -0,0 +1,195 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Small quantized network over (cell, side) features for one board geometry and
+// mode. The first layer is an int16 accumulator the search keeps incrementally:
+// the bias plus the weight row of every occupied (cell, side). The output is the
+// clipped-ReLU accumulator dotted with int16 weights, plus a bias, divided by
+// 2^outputShift, in evaluation units from X's perspective.
+//
+// File layout (little endian): the 8-byte magic "T2NNUE01"; int32 rows, cols,
+// winLen, mode (0 = Classic, 1 = LinesScore), hidden, outputShift; int16 bias
+// [hidden]; int16 weights [rows * cols * 2][hidden], feature = cell * 2 + side
+// with X = 0; int16 output weights [hidden]; int32 output bias.
+class NeuralNet {
+public:
+    static constexpr int LANES = 16;
+    static constexpr int MAX_HIDDEN = 512;
+    static constexpr int ACTIVATION_MAX = 127;
+
+    // Zeroed network; hidden is rounded up to a multiple of LANES.
+    void init(int rows, int cols, int winLen, GameMode mode, int hidden, int outputShift = 6) {
+        rows_ = rows;
+        cols_ = cols;
+        winLen_ = winLen;
+        mode_ = mode;
+        hidden_ = std::max(LANES, std::min(MAX_HIDDEN, (hidden + LANES - 1) / LANES * LANES));
+        outputShift_ = std::max(0, std::min(30, outputShift));
+        bias_.clear();
+        weights_.clear();
+        outputWeights_.clear();
+        outputBias_ = 0;
+        fill(bias_, static_cast<size_t>(hidden_));
+        fill(weights_, static_cast<size_t>(rows_ * cols_ * 2 * hidden_));
+        fill(outputWeights_, static_cast<size_t>(hidden_));
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        char magic[8];
+        int32_t header[6];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(magic)) != 0) return false;
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] <= 0 || header[1] <= 0 || header[0] * header[1] > 32 * 32 || header[2] <= 0 ||
+            (header[3] != 0 && header[3] != 1) || header[4] <= 0 || header[4] > MAX_HIDDEN ||
+            header[4] % LANES != 0 || header[5] < 0 || header[5] > 30) {
+            return false;
+        }
+        NeuralNet net;
+        net.init(header[0], header[1], header[2], header[3] == 0 ? GameMode::Classic : GameMode::LinesScore, header[4], header[5]);
+        if (!readArray(in, net.bias_) || !readArray(in, net.weights_) || !readArray(in, net.outputWeights_)) return false;
+        if (!in.read(reinterpret_cast<char*>(&net.outputBias_), sizeof(net.outputBias_))) return false;
+        *this = std::move(net);
+        return true;
+    }
+
+    bool save(const std::string& path) const {
+        if (!ready()) return false;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        int32_t header[6] = { rows_, cols_, winLen_, mode_ == GameMode::Classic ? 0 : 1, hidden_, outputShift_ };
+        out.write(MAGIC, 8);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        writeArray(out, bias_);
+        writeArray(out, weights_);
+        writeArray(out, outputWeights_);
+        out.write(reinterpret_cast<const char*>(&outputBias_), sizeof(outputBias_));
+        return static_cast<bool>(out);
+    }
+
+    bool ready() const { return hidden_ > 0; }
+    bool matches(int rows, int cols, int winLen, GameMode mode) const {
+        return ready() && rows == rows_ && cols == cols_ && winLen == winLen_ && mode == mode_;
+    }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int winLength() const { return winLen_; }
+    GameMode mode() const { return mode_; }
+    int hidden() const { return hidden_; }
+    int outputShift() const { return outputShift_; }
+
+    static int feature(int cellIndex, CellState cell) { return cellIndex * 2 + (cell == CellState::X ? 0 : 1); }
+
+    int16_t& bias(int unit) { return bias_[static_cast<size_t>(unit)]; }
+    int16_t& weight(int feature, int unit) { return weights_[static_cast<size_t>(feature * hidden_ + unit)]; }
+    int16_t& outputWeight(int unit) { return outputWeights_[static_cast<size_t>(unit)]; }
+    int32_t& outputBias() { return outputBias_; }
+
+    void refresh(const Board& board, DynamicArray<int16_t>& acc) const {
+        acc.clear();
+        for (int j = 0; j < hidden_; ++j) acc.push_back(bias_[static_cast<size_t>(j)]);
+        int total = rows_ * cols_;
+        for (int idx = 0; idx < total; ++idx) {
+            CellState cell = board.getNoCheck(idx / cols_, idx % cols_);
+            if (cell != CellState::Empty) add(acc, feature(idx, cell));
+        }
+    }
+
+    void add(DynamicArray<int16_t>& acc, int feature) const {
+        int16_t* a = &acc.unchecked(0);
+        const int16_t* w = &weights_.unchecked(static_cast<size_t>(feature * hidden_));
+#ifdef __AVX2__
+        for (int j = 0; j < hidden_; j += LANES) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + j));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + j), _mm256_add_epi16(v, d));
+        }
+#else
+        for (int j = 0; j < hidden_; ++j) a[j] = static_cast<int16_t>(a[j] + w[j]);
+#endif
+    }
+
+    void sub(DynamicArray<int16_t>& acc, int feature) const {
+        int16_t* a = &acc.unchecked(0);
+        const int16_t* w = &weights_.unchecked(static_cast<size_t>(feature * hidden_));
+#ifdef __AVX2__
+        for (int j = 0; j < hidden_; j += LANES) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + j));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + j), _mm256_sub_epi16(v, d));
+        }
+#else
+        for (int j = 0; j < hidden_; ++j) a[j] = static_cast<int16_t>(a[j] - w[j]);
+#endif
+    }
+
+    int evaluate(const DynamicArray<int16_t>& acc) const {
+        const int16_t* a = &acc.unchecked(0);
+        const int16_t* w = &outputWeights_.unchecked(0);
+        int64_t sum = outputBias_;
+#ifdef __AVX2__
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i top = _mm256_set1_epi16(ACTIVATION_MAX);
+        __m256i total = _mm256_setzero_si256();
+        for (int j = 0; j < hidden_; j += LANES) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+            v = _mm256_min_epi16(_mm256_max_epi16(v, zero), top);
+            __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + j));
+            total = _mm256_add_epi32(total, _mm256_madd_epi16(v, o));
+        }
+        __m128i lanes = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0x4e));
+        lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0xb1));
+        sum += _mm_cvtsi128_si32(lanes);
+#else
+        for (int j = 0; j < hidden_; ++j) {
+            int v = std::max(0, std::min(ACTIVATION_MAX, static_cast<int>(a[j])));
+            sum += v * w[j];
+        }
+#endif
+        return static_cast<int>(sum / (int64_t(1) << outputShift_));
+    }
+
+private:
+    static constexpr char MAGIC[9] = "T2NNUE01";
+
+    int rows_ = 0;
+    int cols_ = 0;
+    int winLen_ = 0;
+    GameMode mode_ = GameMode::Classic;
+    int hidden_ = 0;
+    int outputShift_ = 0;
+    DynamicArray<int16_t> bias_;
+    DynamicArray<int16_t> weights_;
+    DynamicArray<int16_t> outputWeights_;
+    int32_t outputBias_ = 0;
+
+    template <typename T>
+    static void fill(DynamicArray<T>& a, size_t n) {
+        a.reserve(n);
+        for (size_t i = 0; i < n; ++i) a.push_back(T(0));
+    }
+
+    template <typename T>
+    static bool readArray(std::istream& in, DynamicArray<T>& a) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!in.read(reinterpret_cast<char*>(&a[i]), sizeof(T))) return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void writeArray(std::ostream& out, const DynamicArray<T>& a) {
+        for (size_t i = 0; i < a.size(); ++i) out.write(reinterpret_cast<const char*>(&a[i]), sizeof(T));
+    }
+};
@@ -0,0 +1,433 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+enum class ProofOutcome {
+    Unknown,
+    Win,
+    Draw,
+    Loss
+};
+
+// Depth-first proof-number search for Classic positions. The outcome for the
+// side to move comes from two proofs: "I can force a win" and "the opponent
+// can force a win"; when both fail the position is a draw.
+class ProofNumberSearch {
+public:
+    static constexpr uint32_t INF = 1u << 30;
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 1u << 18;
+    static constexpr uint64_t DEFAULT_NODE_BUDGET = 2000000;
+
+    explicit ProofNumberSearch(const Board& board)
+        : rows_(board.getRows()), cols_(board.getCols()), winLen_(board.getWinLength())
+    {
+        int total = rows_ * cols_;
+        cells_.reserve(static_cast<size_t>(total));
+        cellWindows_.reserve(static_cast<size_t>(total));
+        for (int i = 0; i < total; ++i) {
+            CellState c = board.getNoCheck(i / cols_, i % cols_);
+            cells_.push_back(c == CellState::X ? 0 : (c == CellState::O ? 1 : EMPTY));
+            if (c == CellState::Empty) ++empty_;
+            cellWindows_.push_back(DynamicArray<int>());
+        }
+        buildWindows();
+        initZobrist();
+    }
+
+    void setNodeBudget(uint64_t nodes) { nodeBudget_ = nodes; }
+    void setMaxEntries(size_t entries) { maxEntries_ = entries > 0 ? entries : 1; }
+    void setCancelFlag(std::atomic<bool>* flag) { cancelFlag_ = flag; }
+    void setDeadline(std::chrono::steady_clock::time_point deadline) {
+        deadline_ = deadline;
+        hasDeadline_ = true;
+    }
+    uint64_t nodes() const { return nodes_; }
+    size_t tableSize() const { return used_; }
+
+    ProofOutcome solve(CellState toMove, Coord& bestMove) {
+        bestMove = Coord(-1, -1);
+        aborted_ = false;
+        allocateTable();
+        int mover = sideOf(toMove);
+        if (hasLine(0) || hasLine(1) || empty_ == 0) return ProofOutcome::Unknown;
+
+        attacker_ = mover;
+        uint32_t pn = 0;
+        uint32_t dn = 0;
+        prove(mover, pn, dn);
+        if (aborted_) return ProofOutcome::Unknown;
+        if (pn == 0) {
+            bestMove = pickMove(mover, ProofOutcome::Win);
+            return bestMove.row() >= 0 ? ProofOutcome::Win : ProofOutcome::Unknown;
+        }
+
+        attacker_ = 1 - mover;
+        prove(mover, pn, dn);
+        if (aborted_) return ProofOutcome::Unknown;
+        if (dn == 0) {
+            bestMove = pickMove(mover, ProofOutcome::Draw);
+            return bestMove.row() >= 0 ? ProofOutcome::Draw : ProofOutcome::Unknown;
+        }
+        bestMove = pickMove(mover, ProofOutcome::Loss);
+        return ProofOutcome::Loss;
+    }
+
+private:
+    static constexpr int EMPTY = 2;
+    static constexpr uint64_t ATTACKER_O_KEY = 0x3c6ef372fe94f82bULL;
+
+    class Window {
+    public:
+        int start = 0;
+        int step = 0;
+        int count[2] = { 0, 0 };
+    };
+
+    // Two-way buckets in a fixed table: solved entries and larger subtrees win
+    // the slot, so the memory bound never throws away a finished proof first.
+    class Entry {
+    public:
+        uint64_t key = 0;
+        uint32_t pn = 1;
+        uint32_t dn = 1;
+        uint64_t work = 0;
+        bool used = false;
+
+        bool solved() const { return pn == 0 || dn == 0; }
+    };
+
+    int rows_;
+    int cols_;
+    int winLen_;
+    int empty_ = 0;
+    DynamicArray<int> cells_;
+    DynamicArray<Window> windows_;
+    DynamicArray<DynamicArray<int>> cellWindows_;
+    DynamicArray<uint64_t> zobrist_;
+    uint64_t hash_ = 0;
+    DynamicArray<Entry> tt_;
+    size_t ttMask_ = 0;
+    size_t used_ = 0;
+    size_t maxEntries_ = DEFAULT_MAX_ENTRIES;
+    int attacker_ = 0;
+    uint64_t nodes_ = 0;
+    uint64_t nodeBudget_ = DEFAULT_NODE_BUDGET;
+    bool aborted_ = false;
+    std::atomic<bool>* cancelFlag_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_{};
+    bool hasDeadline_ = false;
+
+    static int sideOf(CellState c) { return c == CellState::X ? 0 : 1; }
+
+    static uint32_t addSat(uint32_t a, uint32_t b) {
+        uint64_t s = static_cast<uint64_t>(a) + b;
+        return s >= INF ? INF : static_cast<uint32_t>(s);
+    }
+
+    void buildWindows() {
+        const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+        for (int d = 0; d < 4; ++d) {
+            int dr = dirs[d][0];
+            int dc = dirs[d][1];
+            for (int r = 0; r < rows_; ++r) {
+                for (int c = 0; c < cols_; ++c) {
+                    int er = r + (winLen_ - 1) * dr;
+                    int ec = c + (winLen_ - 1) * dc;
+                    if (er < 0 || er >= rows_ || ec < 0 || ec >= cols_) continue;
+                    Window w;
+                    w.start = r * cols_ + c;
+                    w.step = dr * cols_ + dc;
+                    int idx = static_cast<int>(windows_.size());
+                    for (int k = 0; k < winLen_; ++k) {
+                        int cell = w.start + k * w.step;
+                        if (cells_[cell] != EMPTY) ++w.count[cells_[cell]];
+                        cellWindows_[cell].push_back(idx);
+                    }
+                    windows_.push_back(w);
+                }
+            }
+        }
+    }
+
+    void initZobrist() {
+        uint64_t seed = 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(rows_ * 7919 + cols_ * 104729 + winLen_);
+        size_t total = static_cast<size_t>(rows_ * cols_);
+        zobrist_.reserve(total * 2);
+        for (size_t i = 0; i < total * 2; ++i) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            zobrist_.push_back(z ^ (z >> 31));
+        }
+        for (size_t i = 0; i < total; ++i) {
+            if (cells_[i] != EMPTY) hash_ ^= zobrist_[i * 2 + static_cast<size_t>(cells_[i])];
+        }
+    }
+
+    // Returns true when the stone completes a line.
+    bool place(int cell, int side) {
+        cells_[cell] = side;
+        --empty_;
+        hash_ ^= zobrist_[static_cast<size_t>(cell * 2 + side)];
+        bool won = false;
+        DynamicArray<int>& wins = cellWindows_[cell];
+        for (size_t i = 0; i < wins.size(); ++i) {
+            if (++windows_[wins[i]].count[side] == winLen_) won = true;
+        }
+        return won;
+    }
+
+    void remove(int cell, int side) {
+        cells_[cell] = EMPTY;
+        ++empty_;
+        hash_ ^= zobrist_[static_cast<size_t>(cell * 2 + side)];
+        DynamicArray<int>& wins = cellWindows_[cell];
+        for (size_t i = 0; i < wins.size(); ++i) --windows_[wins[i]].count[side];
+    }
+
+    bool hasLine(int side) const {
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            if (windows_[i].count[side] == winLen_) return true;
+        }
+        return false;
+    }
+
+    int winningCell(int side) const {
+        int other = 1 - side;
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const Window& w = windows_[i];
+            if (w.count[side] != winLen_ - 1 || w.count[other] != 0) continue;
+            for (int k = 0; k < winLen_; ++k) {
+                int cell = w.start + k * w.step;
+                if (cells_[cell] == EMPTY) return cell;
+            }
+        }
+        return -1;
+    }
+
+    // A mover facing an open line must block it unless it wins first.
+    void generateMoves(int toMove, DynamicArray<int>& out) const {
+        out.clear();
+        int own = winningCell(toMove);
+        if (own >= 0) {
+            out.push_back(own);
+            return;
+        }
+        int block = winningCell(1 - toMove);
+        if (block >= 0) {
+            out.push_back(block);
+            return;
+        }
+        for (size_t i = 0; i < cells_.size(); ++i) {
+            if (cells_[i] == EMPTY) out.push_back(static_cast<int>(i));
+        }
+    }
+
+    // Every window the attacker could still fill needs more stones than it has moves left.
+    bool attackerCannotWin(int toMove) const {
+        int movesLeft = (toMove == attacker_) ? (empty_ + 1) / 2 : empty_ / 2;
+        int defender = 1 - attacker_;
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const Window& w = windows_[i];
+            if (w.count[defender] == 0 && winLen_ - w.count[attacker_] <= movesLeft) return false;
+        }
+        return true;
+    }
+
+    uint64_t key() const { return hash_ ^ (attacker_ == 0 ? 0 : ATTACKER_O_KEY); }
+
+    void allocateTable() {
+        size_t size = 2;
+        while (size * 2 <= maxEntries_) size *= 2;
+        if (tt_.size() == size) return;
+        tt_.clear();
+        tt_.reserve(size);
+        for (size_t i = 0; i < size; ++i) tt_.push_back(Entry());
+        ttMask_ = size - 1;
+        used_ = 0;
+    }
+
+    void store(uint32_t pn, uint32_t dn, uint64_t work) {
+        uint64_t k = key();
+        size_t first = static_cast<size_t>(k) & ttMask_;
+        size_t second = first ^ 1;
+        Entry* slot = nullptr;
+        if (tt_[first].used && tt_[first].key == k) slot = &tt_[first];
+        else if (tt_[second].used && tt_[second].key == k) slot = &tt_[second];
+        else if (!tt_[first].used) slot = &tt_[first];
+        else if (!tt_[second].used) slot = &tt_[second];
+        if (!slot) {
+            Entry& a = tt_[first];
+            Entry& b = tt_[second];
+            slot = (a.solved() != b.solved()) ? (a.solved() ? &b : &a) : (a.work <= b.work ? &a : &b);
+        }
+        bool sameKey = slot->used && slot->key == k;
+        if (!slot->used) ++used_;
+        slot->key = k;
+        slot->pn = pn;
+        slot->dn = dn;
+        slot->work = sameKey ? std::max(slot->work, work) : work;
+        slot->used = true;
+    }
+
+    void lookup(int toMove, uint32_t& pn, uint32_t& dn) const {
+        (void)toMove;
+        uint64_t k = key();
+        size_t first = static_cast<size_t>(k) & ttMask_;
+        const Entry* e = nullptr;
+        if (tt_[first].used && tt_[first].key == k) e = &tt_[first];
+        else if (tt_[first ^ 1].used && tt_[first ^ 1].key == k) e = &tt_[first ^ 1];
+        if (e) {
+            pn = e->pn;
+            dn = e->dn;
+        } else {
+            pn = 1;
+            dn = 1;
+        }
+    }
+
+    // Proof/disproof numbers of the child reached by `toMove` playing `cell`.
+    void childNumbers(int cell, int toMove, uint32_t& pn, uint32_t& dn) {
+        bool won = place(cell, toMove);
+        if (won) {
+            pn = (toMove == attacker_) ? 0 : INF;
+            dn = (toMove == attacker_) ? INF : 0;
+        } else if (empty_ == 0 || attackerCannotWin(1 - toMove)) {
+            pn = INF;
+            dn = 0;
+        } else {
+            lookup(1 - toMove, pn, dn);
+        }
+        remove(cell, toMove);
+    }
+
+    bool outOfBudget() {
+        if (aborted_) return true;
+        if (nodeBudget_ > 0 && nodes_ >= nodeBudget_) aborted_ = true;
+        else if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) aborted_ = true;
+        else if (hasDeadline_ && (nodes_ & 1023) == 0 && std::chrono::steady_clock::now() >= deadline_) aborted_ = true;
+        return aborted_;
+    }
+
+    void prove(int toMove, uint32_t& pn, uint32_t& dn) {
+        mid(toMove, INF, INF);
+        lookup(toMove, pn, dn);
+    }
+
+    void mid(int toMove, uint32_t thpn, uint32_t thdn) {
+        uint64_t startNodes = nodes_;
+        ++nodes_;
+        if (outOfBudget()) return;
+        bool orNode = (toMove == attacker_);
+        DynamicArray<int> moves;
+        generateMoves(toMove, moves);
+        DynamicArray<uint32_t> cpn;
+        DynamicArray<uint32_t> cdn;
+        cpn.reserve(moves.size());
+        cdn.reserve(moves.size());
+        for (size_t i = 0; i < moves.size(); ++i) {
+            cpn.push_back(0);
+            cdn.push_back(0);
+        }
+
+        while (true) {
+            uint32_t pn = orNode ? INF : 0;
+            uint32_t dn = orNode ? 0 : INF;
+            size_t best = 0;
+            uint32_t bestVal = INF + 1;
+            uint32_t secondVal = INF;
+            for (size_t i = 0; i < moves.size(); ++i) {
+                childNumbers(moves[i], toMove, cpn[i], cdn[i]);
+                uint32_t v = orNode ? cpn[i] : cdn[i];
+                if (orNode) {
+                    pn = std::min(pn, cpn[i]);
+                    dn = addSat(dn, cdn[i]);
+                } else {
+                    pn = addSat(pn, cpn[i]);
+                    dn = std::min(dn, cdn[i]);
+                }
+                if (v < bestVal) {
+                    secondVal = bestVal;
+                    bestVal = v;
+                    best = i;
+                } else if (v < secondVal) {
+                    secondVal = v;
+                }
+            }
+            if (pn >= thpn || dn >= thdn || aborted_) {
+                store(pn, dn, nodes_ - startNodes);
+                return;
+            }
+            uint32_t childThpn;
+            uint32_t childThdn;
+            uint32_t second = std::min<uint32_t>(secondVal, INF - 1);
+            if (orNode) {
+                childThpn = std::min(thpn, second + 1);
+                childThdn = (thdn >= INF) ? INF : addSat(thdn - dn, cdn[best]);
+            } else {
+                childThdn = std::min(thdn, second + 1);
+                childThpn = (thpn >= INF) ? INF : addSat(thpn - pn, cpn[best]);
+            }
+            place(moves[best], toMove);
+            mid(1 - toMove, childThpn, childThdn);
+            remove(moves[best], toMove);
+            if (aborted_) {
+                store(pn, dn, nodes_ - startNodes);
+                return;
+            }
+        }
+    }
+
+    // Win: a child the mover has proven; Draw: a child the opponent cannot win.
+    // A child whose table entry was evicted is proven again, so a Win or Draw is
+    // never reported with an unproven move; (-1, -1) when that fails. Loss: the
+    // child hardest for the opponent to prove.
+    Coord pickMove(int toMove, ProofOutcome outcome) {
+        DynamicArray<int> moves;
+        generateMoves(toMove, moves);
+        int bestCell = -1;
+        if (outcome == ProofOutcome::Loss) {
+            uint32_t bestPn = 0;
+            for (size_t i = 0; i < moves.size(); ++i) {
+                uint32_t pn = 0;
+                uint32_t dn = 0;
+                childNumbers(moves[i], toMove, pn, dn);
+                if (bestCell < 0 || pn > bestPn) {
+                    bestPn = pn;
+                    bestCell = moves[i];
+                }
+            }
+        } else {
+            bool win = (outcome == ProofOutcome::Win);
+            for (int reprove = 0; reprove < 2 && bestCell < 0; ++reprove) {
+                for (size_t i = 0; i < moves.size() && !aborted_; ++i) {
+                    if (childSolved(moves[i], toMove, win, reprove == 1)) {
+                        bestCell = moves[i];
+                        break;
+                    }
+                }
+            }
+        }
+        if (bestCell < 0) return Coord(-1, -1);
+        return Coord(bestCell / cols_, bestCell % cols_);
+    }
+
+    // win: proven for the mover (pn == 0), otherwise disproven for the opponent
+    // (dn == 0). With reprove an unsolved child is searched again.
+    bool childSolved(int cell, int toMove, bool win, bool reprove) {
+        uint32_t pn = 0;
+        uint32_t dn = 0;
+        childNumbers(cell, toMove, pn, dn);
+        if (win ? pn == 0 : dn == 0) return true;
+        if (!reprove || pn == 0 || dn == 0) return false;
+        place(cell, toMove);
+        prove(1 - toMove, pn, dn);
+        remove(cell, toMove);
+        return !aborted_ && (win ? pn == 0 : dn == 0);
+    }
+};
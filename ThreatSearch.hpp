@@ -0,0 +1,335 @@
+#pragma once
+#include "Board.hpp"
+#include "DynamicArray.hpp"
+#include "HashMap.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Threat-space search for Classic k-in-a-row: VCF (continuous fours) and VCT
+// (fours and threes). Only threat moves of the attacker and forced replies of
+// the defender are expanded, so long forcing wins are found far beyond the
+// depth of the main search. A VCF win is proven; a VCT win is not, because
+// the defender's threes and own VCF are never tried as refutations, so callers
+// should treat it as a hint only.
+class ThreatSearch {
+public:
+    static constexpr int DEFAULT_VCF_DEPTH = 16;
+    static constexpr int DEFAULT_VCT_DEPTH = 4;
+    static constexpr uint64_t DEFAULT_NODE_BUDGET = 20000;
+
+    explicit ThreatSearch(const Board& board)
+        : rows_(board.getRows()), cols_(board.getCols()), winLen_(board.getWinLength())
+    {
+        int total = rows_ * cols_;
+        cells_.reserve(static_cast<size_t>(total));
+        cellWindows_.reserve(static_cast<size_t>(total));
+        for (int i = 0; i < total; ++i) {
+            CellState c = board.getNoCheck(i / cols_, i % cols_);
+            cells_.push_back(c == CellState::X ? 0 : (c == CellState::O ? 1 : EMPTY));
+            cellWindows_.push_back(DynamicArray<int>());
+        }
+        buildWindows();
+        initZobrist();
+        marks_.reserve(static_cast<size_t>(total));
+        for (int i = 0; i < total; ++i) marks_.push_back(0);
+    }
+
+    void setNodeBudget(uint64_t nodes) { nodeBudget_ = nodes; }
+    void setCancelFlag(std::atomic<bool>* flag) { cancelFlag_ = flag; }
+    void setDeadline(std::chrono::steady_clock::time_point deadline) {
+        deadline_ = deadline;
+        hasDeadline_ = true;
+    }
+    uint64_t nodes() const { return nodes_; }
+    bool budgetExhausted() const { return aborted_; }
+
+    // On success line holds the attacker's winning sequence: attacker move,
+    // defender reply, ... , final winning move (AND-nodes keep one refutation).
+    bool findVCF(CellState attacker, DynamicArray<Coord>& line, int maxDepth = DEFAULT_VCF_DEPTH) {
+        line.clear();
+        aborted_ = false;
+        DynamicArray<int> seq;
+        bool found = vcf(sideOf(attacker), maxDepth, seq);
+        toCoords(seq, line);
+        return found && !aborted_;
+    }
+
+    bool findVCT(CellState attacker, DynamicArray<Coord>& line, int maxDepth = DEFAULT_VCT_DEPTH, int vcfDepth = DEFAULT_VCF_DEPTH) {
+        line.clear();
+        aborted_ = false;
+        vcfDepth_ = vcfDepth;
+        DynamicArray<int> seq;
+        bool found = vct(sideOf(attacker), maxDepth, seq);
+        toCoords(seq, line);
+        return found && !aborted_;
+    }
+
+private:
+    static constexpr int EMPTY = 2;
+    static constexpr uint64_t ATTACKER_O_KEY = 0x6a09e667f3bcc909ULL;
+
+    class Window {
+    public:
+        int start = 0;
+        int step = 0;
+        int count[2] = { 0, 0 };
+    };
+
+    int rows_;
+    int cols_;
+    int winLen_;
+    DynamicArray<int> cells_;
+    DynamicArray<Window> windows_;
+    DynamicArray<DynamicArray<int>> cellWindows_;
+    DynamicArray<uint64_t> zobrist_;
+    uint64_t hash_ = 0;
+    HashMap<uint64_t, int> vcfFailDepth_;
+    DynamicArray<int> marks_;
+    int markEpoch_ = 0;
+    uint64_t nodes_ = 0;
+    uint64_t nodeBudget_ = DEFAULT_NODE_BUDGET;
+    bool aborted_ = false;
+    int vcfDepth_ = DEFAULT_VCF_DEPTH;
+    std::atomic<bool>* cancelFlag_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_{};
+    bool hasDeadline_ = false;
+
+    static int sideOf(CellState c) { return c == CellState::X ? 0 : 1; }
+
+    static void truncate(DynamicArray<int>& seq, size_t size) {
+        while (seq.size() > size) seq.pop_back();
+    }
+
+    void buildWindows() {
+        const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+        for (int d = 0; d < 4; ++d) {
+            int dr = dirs[d][0];
+            int dc = dirs[d][1];
+            for (int r = 0; r < rows_; ++r) {
+                for (int c = 0; c < cols_; ++c) {
+                    int er = r + (winLen_ - 1) * dr;
+                    int ec = c + (winLen_ - 1) * dc;
+                    if (er < 0 || er >= rows_ || ec < 0 || ec >= cols_) continue;
+                    Window w;
+                    w.start = r * cols_ + c;
+                    w.step = dr * cols_ + dc;
+                    int idx = static_cast<int>(windows_.size());
+                    for (int k = 0; k < winLen_; ++k) {
+                        int cell = w.start + k * w.step;
+                        if (cells_[cell] != EMPTY) ++w.count[cells_[cell]];
+                        cellWindows_[cell].push_back(idx);
+                    }
+                    windows_.push_back(w);
+                }
+            }
+        }
+    }
+
+    void initZobrist() {
+        uint64_t seed = 0x2545f4914f6cdd1dULL ^ static_cast<uint64_t>(rows_ * 977 + cols_ * 31 + winLen_);
+        size_t total = static_cast<size_t>(rows_ * cols_);
+        zobrist_.reserve(total * 2);
+        for (size_t i = 0; i < total * 2; ++i) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            zobrist_.push_back(z ^ (z >> 31));
+        }
+        for (size_t i = 0; i < total; ++i) {
+            if (cells_[i] != EMPTY) hash_ ^= zobrist_[i * 2 + static_cast<size_t>(cells_[i])];
+        }
+    }
+
+    void place(int cell, int side) {
+        cells_[cell] = side;
+        hash_ ^= zobrist_[static_cast<size_t>(cell * 2 + side)];
+        DynamicArray<int>& wins = cellWindows_[cell];
+        for (size_t i = 0; i < wins.size(); ++i) ++windows_[wins[i]].count[side];
+    }
+
+    void remove(int cell, int side) {
+        cells_[cell] = EMPTY;
+        hash_ ^= zobrist_[static_cast<size_t>(cell * 2 + side)];
+        DynamicArray<int>& wins = cellWindows_[cell];
+        for (size_t i = 0; i < wins.size(); ++i) --windows_[wins[i]].count[side];
+    }
+
+    bool outOfBudget() {
+        if (aborted_) return true;
+        if (nodeBudget_ > 0 && nodes_ >= nodeBudget_) aborted_ = true;
+        else if (cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed)) aborted_ = true;
+        else if (hasDeadline_ && (nodes_ & 255) == 0 && std::chrono::steady_clock::now() >= deadline_) aborted_ = true;
+        return aborted_;
+    }
+
+    void nextMarkEpoch() {
+        if (++markEpoch_ == 0) {
+            for (size_t i = 0; i < marks_.size(); ++i) marks_[i] = 0;
+            markEpoch_ = 1;
+        }
+    }
+
+    // Empty cells of windows where side has `need` stones and the opponent none.
+    void collectCells(int side, int need, DynamicArray<int>& out) {
+        out.clear();
+        nextMarkEpoch();
+        int other = 1 - side;
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const Window& w = windows_[i];
+            if (w.count[side] != need || w.count[other] != 0) continue;
+            for (int k = 0; k < winLen_; ++k) {
+                int cell = w.start + k * w.step;
+                if (cells_[cell] != EMPTY || marks_[cell] == markEpoch_) continue;
+                marks_[cell] = markEpoch_;
+                out.push_back(cell);
+            }
+        }
+    }
+
+    void winningCells(int side, DynamicArray<int>& out) { collectCells(side, winLen_ - 1, out); }
+    void fourMoves(int side, DynamicArray<int>& out) { collectCells(side, winLen_ - 2, out); }
+
+    bool vcf(int att, int depth, DynamicArray<int>& seq) {
+        ++nodes_;
+        if (outOfBudget()) return false;
+        int def = 1 - att;
+        DynamicArray<int> wins;
+        winningCells(att, wins);
+        if (!wins.empty()) {
+            seq.push_back(wins[0]);
+            return true;
+        }
+        if (depth <= 0) return false;
+        DynamicArray<int> defWins;
+        winningCells(def, defWins);
+        if (defWins.size() >= 2) return false;
+        uint64_t key = hash_ ^ (att == 0 ? 0 : ATTACKER_O_KEY);
+        if (vcfFailDepth_.contains(key) && vcfFailDepth_.get(key) >= depth) return false;
+
+        DynamicArray<int> candidates;
+        fourMoves(att, candidates);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            int mv = candidates[i];
+            if (defWins.size() == 1 && mv != defWins[0]) continue;
+            place(mv, att);
+            DynamicArray<int> threats;
+            winningCells(att, threats);
+            bool won = false;
+            if (threats.size() >= 2) {
+                seq.push_back(mv);
+                seq.push_back(threats[0]);
+                seq.push_back(threats[1]);
+                won = true;
+            } else if (threats.size() == 1) {
+                int block = threats[0];
+                place(block, def);
+                size_t mark = seq.size();
+                seq.push_back(mv);
+                seq.push_back(block);
+                won = vcf(att, depth - 1, seq);
+                if (!won) truncate(seq, mark);
+                remove(block, def);
+            }
+            remove(mv, att);
+            if (won) return true;
+            if (aborted_) return false;
+        }
+        vcfFailDepth_.insert(key, depth);
+        return false;
+    }
+
+    // A quiet threat is sound only if the attacker wins by VCF after a pass;
+    // the defender then has to touch that line or answer with a four of its own.
+    bool vct(int att, int depth, DynamicArray<int>& seq) {
+        ++nodes_;
+        if (outOfBudget()) return false;
+        int def = 1 - att;
+        size_t mark = seq.size();
+        if (vcf(att, vcfDepth_, seq)) return true;
+        truncate(seq, mark);
+        if (depth <= 0 || aborted_) return false;
+        DynamicArray<int> defWins;
+        winningCells(def, defWins);
+        if (!defWins.empty()) return false;
+
+        DynamicArray<int> candidates;
+        fourMoves(att, candidates);
+        if (winLen_ >= 4) {
+            DynamicArray<int> threes;
+            collectCells(att, winLen_ - 3, threes);
+            nextMarkEpoch();
+            for (size_t i = 0; i < candidates.size(); ++i) marks_[candidates[i]] = markEpoch_;
+            for (size_t i = 0; i < threes.size(); ++i) {
+                if (marks_[threes[i]] != markEpoch_) candidates.push_back(threes[i]);
+            }
+        }
+        DynamicArray<int> defFours;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            int mv = candidates[i];
+            place(mv, att);
+            DynamicArray<int> threats;
+            winningCells(att, threats);
+            bool won = false;
+            if (threats.size() >= 2) {
+                seq.push_back(mv);
+                seq.push_back(threats[0]);
+                seq.push_back(threats[1]);
+                won = true;
+            } else if (threats.size() == 1) {
+                int block = threats[0];
+                place(block, def);
+                seq.push_back(mv);
+                seq.push_back(block);
+                won = vct(att, depth - 1, seq);
+                if (!won) truncate(seq, mark);
+                remove(block, def);
+            } else {
+                DynamicArray<int> line;
+                if (vcf(att, vcfDepth_, line)) {
+                    DynamicArray<int> defences;
+                    nextMarkEpoch();
+                    for (size_t k = 0; k < line.size(); ++k) {
+                        if (marks_[line[k]] == markEpoch_) continue;
+                        marks_[line[k]] = markEpoch_;
+                        defences.push_back(line[k]);
+                    }
+                    fourMoves(def, defFours);
+                    nextMarkEpoch();
+                    for (size_t k = 0; k < defences.size(); ++k) marks_[defences[k]] = markEpoch_;
+                    for (size_t k = 0; k < defFours.size(); ++k) {
+                        if (marks_[defFours[k]] != markEpoch_) defences.push_back(defFours[k]);
+                    }
+                    won = true;
+                    DynamicArray<int> sub;
+                    DynamicArray<int> firstSub;
+                    for (size_t k = 0; k < defences.size() && won; ++k) {
+                        place(defences[k], def);
+                        sub.clear();
+                        won = vct(att, depth - 1, sub);
+                        remove(defences[k], def);
+                        if (won && k == 0) {
+                            firstSub.push_back(defences[k]);
+                            for (size_t j = 0; j < sub.size(); ++j) firstSub.push_back(sub[j]);
+                        }
+                    }
+                    if (won) {
+                        seq.push_back(mv);
+                        for (size_t j = 0; j < firstSub.size(); ++j) seq.push_back(firstSub[j]);
+                    }
+                }
+            }
+            remove(mv, att);
+            if (won) return true;
+            if (aborted_) return false;
+        }
+        return false;
+    }
+
+    void toCoords(const DynamicArray<int>& seq, DynamicArray<Coord>& out) const {
+        out.clear();
+        out.reserve(seq.size());
+        for (size_t i = 0; i < seq.size(); ++i) out.push_back(Coord(seq[i] / cols_, seq[i] % cols_));
+    }
+};
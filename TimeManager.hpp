@@ -0,0 +1,94 @@
+#pragma once
+#include "Board.hpp"
+#include <algorithm>
+#include <limits>
+
+class TimeManager {
+public:
+    static constexpr int SAFETY_MARGIN_MS = 30;
+    static constexpr int MAX_MOVES_TO_GO = 30;
+    static constexpr int STABLE_ITERATIONS = 3;
+
+    // remainingMs/incrementMs describe the game clock (<= 0: no clock),
+    // moveTimeMs is a fixed per-move limit (<= 0: none). Without either the search is unbounded.
+    // A fixed move time alone keeps soft == hard: the user asked for that much time.
+    void startMove(int remainingMs, int incrementMs, int filledCells, int emptyCells, int moveTimeMs) {
+        softLimitMs_ = -1;
+        hardLimitMs_ = -1;
+        clocked_ = remainingMs > 0;
+        resetIterations();
+
+        if (remainingMs > 0) {
+            int ownMovesLeft = std::max(1, (emptyCells + 1) / 2);
+            int horizon = std::max(8, MAX_MOVES_TO_GO - filledCells / 4);
+            int movesToGo = std::min(ownMovesLeft, horizon);
+            int usable = std::max(1, remainingMs - SAFETY_MARGIN_MS);
+            int inc = std::max(0, incrementMs);
+            int base = usable / movesToGo + inc * 3 / 4;
+            int hardCap = std::max(1, usable / 3 + inc);
+            softLimitMs_ = std::max(1, std::min(base, hardCap));
+            hardLimitMs_ = std::max(softLimitMs_, std::min(base * 4, hardCap));
+            if (moveTimeMs > 0) {
+                hardLimitMs_ = std::min(hardLimitMs_, moveTimeMs);
+                softLimitMs_ = std::min(softLimitMs_, hardLimitMs_);
+            }
+        } else if (moveTimeMs > 0) {
+            hardLimitMs_ = moveTimeMs;
+            softLimitMs_ = moveTimeMs;
+        }
+    }
+
+    void resetIterations() {
+        lastBest_ = Coord(-1, -1);
+        lastScore_ = std::numeric_limits<int>::min();
+        stableIterations_ = 0;
+        scale_ = 1.0;
+    }
+
+    void onIterationComplete(const Coord& best, int score, int scoreDropMargin) {
+        bool first = (lastBest_.row() < 0);
+        if (!first && best == lastBest_) {
+            ++stableIterations_;
+        } else {
+            stableIterations_ = 0;
+        }
+
+        double scale = 1.0;
+        if (!first && best != lastBest_) {
+            scale = 1.4;
+        } else if (stableIterations_ >= STABLE_ITERATIONS) {
+            scale = 0.5;
+        } else if (stableIterations_ >= 1) {
+            scale = 0.8;
+        }
+        if (!first && lastScore_ != std::numeric_limits<int>::min() &&
+            static_cast<long long>(score) < static_cast<long long>(lastScore_) - scoreDropMargin) {
+            scale = std::max(scale, 1.0) * 1.5;
+        }
+        scale_ = std::min(scale, 2.0);
+        lastBest_ = best;
+        lastScore_ = score;
+    }
+
+    bool canStartIteration(long long elapsedMs) const {
+        if (softLimitMs_ <= 0) return true;
+        // Stability scaling only spends a game clock; a fixed move time is used in full.
+        double budget = static_cast<double>(softLimitMs_) * (clocked_ ? scale_ : 1.0);
+        if (hardLimitMs_ > 0) budget = std::min(budget, static_cast<double>(hardLimitMs_));
+        return static_cast<double>(elapsedMs) < budget;
+    }
+
+    int softLimitMs() const { return softLimitMs_; }
+    int hardLimitMs() const { return hardLimitMs_; }
+    int stableIterations() const { return stableIterations_; }
+    double scale() const { return scale_; }
+
+private:
+    int softLimitMs_ = -1;
+    int hardLimitMs_ = -1;
+    bool clocked_ = false;
+    Coord lastBest_ = Coord(-1, -1);
+    int lastScore_ = std::numeric_limits<int>::min();
+    int stableIterations_ = 0;
+    double scale_ = 1.0;
+};
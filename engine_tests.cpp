@@ -0,0 +1,1510 @@
+#include "GameController.hpp"
+#include "CpuQuota.hpp"
+#include "TimeManager.hpp"
+#include "ThreatSearch.hpp"
+#include "ProofNumberSearch.hpp"
+#include "LinesEndgame.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+namespace {
+int failures = 0;
+
+void reportFailure(const char* testName, int line) {
+    std::cerr << "FAIL: " << testName << " at line " << line << "\n";
+    ++failures;
+}
+
+#define CHECK(testName, expr) \
+    do { \
+        if (!(expr)) { \
+            reportFailure(testName, __LINE__); \
+            return; \
+        } \
+    } while (0)
+
+class FakeCgroup {
+public:
+    explicit FakeCgroup(const std::string& name)
+        : root_(std::filesystem::temp_directory_path() / ("tictactoe2_cgroup_" + name))
+    {
+        std::filesystem::remove_all(root_);
+        std::filesystem::create_directories(root_);
+    }
+    ~FakeCgroup() {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void write(const std::string& relPath, const std::string& content) const {
+        std::filesystem::path p = root_ / relPath;
+        std::filesystem::create_directories(p.parent_path());
+        std::ofstream out(p);
+        out << content;
+    }
+
+    std::string root() const { return root_.string(); }
+
+private:
+    std::filesystem::path root_;
+};
+
+void testCgroupV2Quota() {
+    const char* name = "testCgroupV2Quota";
+    FakeCgroup cg("v2");
+    cg.write("cpu.max", "150000 100000\n");
+    CHECK(name, CpuQuota::readCgroupV2(cg.root()) == 2);
+    CHECK(name, CpuQuota::readCgroupQuota(cg.root()) == 2);
+
+    cg.write("cpu.max", "max 100000\n");
+    CHECK(name, CpuQuota::readCgroupV2(cg.root()) == 0);
+
+    cg.write("cpu.max", "20000 100000\n");
+    CHECK(name, CpuQuota::readCgroupV2(cg.root()) == 1);
+}
+
+void testCgroupV1Quota() {
+    const char* name = "testCgroupV1Quota";
+    FakeCgroup cg("v1");
+    cg.write("cpu/cpu.cfs_quota_us", "300000\n");
+    cg.write("cpu/cpu.cfs_period_us", "100000\n");
+    CHECK(name, CpuQuota::readCgroupV2(cg.root()) == 0);
+    CHECK(name, CpuQuota::readCgroupV1(cg.root()) == 3);
+    CHECK(name, CpuQuota::readCgroupQuota(cg.root()) == 3);
+
+    cg.write("cpu/cpu.cfs_quota_us", "-1\n");
+    CHECK(name, CpuQuota::readCgroupV1(cg.root()) == 0);
+}
+
+void testDetectRespectsQuota() {
+    const char* name = "testDetectRespectsQuota";
+    FakeCgroup cg("detect");
+    cg.write("cpu.max", "100000 100000\n");
+    CHECK(name, CpuQuota::detect(cg.root()) == 1);
+
+    FakeCgroup none("none");
+    CHECK(name, CpuQuota::detect(none.root()) >= 1);
+}
+
+void testThreadBudgetResolution() {
+    const char* name = "testThreadBudgetResolution";
+    CHECK(name, CpuQuota::resolveThreadBudget(0, 16) == CpuQuota::DEFAULT_THREAD_CAP);
+    CHECK(name, CpuQuota::resolveThreadBudget(0, 2) == 2);
+    CHECK(name, CpuQuota::resolveThreadBudget(0, 1) == 1);
+    CHECK(name, CpuQuota::resolveThreadBudget(0, 0) == 2);
+    CHECK(name, CpuQuota::resolveThreadBudget(6, 2) == 6);
+    CHECK(name, CpuQuota::resolveThreadBudget(500, 2) == CpuQuota::MAX_THREAD_BUDGET);
+
+    SearchParams params;
+    CHECK(name, params.threadBudget() == 0);
+    params.setThreadBudget(3);
+    CHECK(name, params.threadBudget() == 3);
+}
+
+void testPonderHitAndMiss() {
+    const char* name = "testPonderHitAndMiss";
+    GameController gc(7, 7, 4, GameMode::Classic, OpeningRule::None);
+    gc.setPonderEnabled(true);
+    CHECK(name, gc.applyMove(3, 3) == MoveStatus::Ok);
+    CHECK(name, gc.applyMove(3, 4) == MoveStatus::Ok);
+
+    AIStatistics stats;
+    MoveEvaluation aiMove = gc.findBestMoveForSeat(Seat::A, Player::X, 3, true, stats);
+    CHECK(name, aiMove.move.row() >= 0);
+    CHECK(name, gc.applyMove(aiMove.move.row(), aiMove.move.col()) == MoveStatus::Ok);
+
+    CHECK(name, gc.startPondering(Seat::A, 3, true));
+    Coord expected = gc.ponderExpectedReply();
+    CHECK(name, expected.row() >= 0);
+    CHECK(name, gc.applyMove(expected.row(), expected.col()) == MoveStatus::Ok);
+    MoveEvaluation reply = gc.findBestMoveForSeat(Seat::A, Player::X, 3, true, stats);
+    CHECK(name, gc.ponderHits() == 1);
+    CHECK(name, !gc.isPondering());
+    CHECK(name, reply.move.row() >= 0);
+    CHECK(name, gc.applyMove(reply.move.row(), reply.move.col()) == MoveStatus::Ok);
+
+    CHECK(name, gc.startPondering(Seat::A, 3, true));
+    expected = gc.ponderExpectedReply();
+    Board b = gc.boardSnapshot();
+    Coord other(-1, -1);
+    for (int r = 0; r < b.getRows() && other.row() < 0; ++r) {
+        for (int c = 0; c < b.getCols(); ++c) {
+            if (b.isEmpty(r, c) && Coord(r, c) != expected) {
+                other = Coord(r, c);
+                break;
+            }
+        }
+    }
+    CHECK(name, gc.applyMove(other.row(), other.col()) == MoveStatus::Ok);
+    MoveEvaluation afterMiss = gc.findBestMoveForSeat(Seat::A, Player::X, 3, true, stats);
+    CHECK(name, gc.ponderMisses() == 1);
+    CHECK(name, afterMiss.move.row() >= 0);
+
+    // A miss keeps the TT of a search that was cut off mid-iteration (here by a node
+    // limit, so the cut is reproducible); the next search must match a cold one.
+    Board base(9, 9, 5);
+    base.set(4, 4, CellState::X);
+    base.set(4, 5, CellState::O);
+    base.set(3, 4, CellState::X);
+    Board predicted = base;
+    predicted.set(6, 4, CellState::O);
+    Board actual = base;
+    actual.set(6, 3, CellState::O);
+    MinimaxAI warm(Player::X, 12, true, GameMode::Classic);
+    warm.setThreadBudget(1);
+    warm.setUseThreatSearch(false);
+    warm.setNodeLimit(60000);
+    warm.findBestMove(predicted);
+    CHECK(name, warm.getStatistics().nodeLimitHit);
+    warm.keepTranspositionsForNextSearch();
+    warm.setNodeLimit(0);
+    warm.setMaxDepth(4);
+    MoveEvaluation carried = warm.findBestMove(actual);
+    MinimaxAI cold(Player::X, 4, true, GameMode::Classic);
+    cold.setThreadBudget(1);
+    cold.setUseThreatSearch(false);
+    MoveEvaluation fresh = cold.findBestMove(actual);
+    CHECK(name, carried.move == fresh.move && carried.score == fresh.score);
+}
+
+void testTimeManagerBudgets() {
+    const char* name = "testTimeManagerBudgets";
+    TimeManager tm;
+    tm.startMove(-1, 0, 0, 49, -1);
+    CHECK(name, tm.softLimitMs() < 0 && tm.hardLimitMs() < 0);
+    CHECK(name, tm.canStartIteration(1000000));
+
+    tm.startMove(-1, 0, 0, 49, 400);
+    CHECK(name, tm.hardLimitMs() == 400);
+    CHECK(name, tm.softLimitMs() == 400);
+    for (int i = 0; i < TimeManager::STABLE_ITERATIONS + 1; ++i) {
+        tm.onIterationComplete(Coord(3, 3), 100, 200);
+    }
+    CHECK(name, tm.canStartIteration(399));
+
+    tm.startMove(10000, 100, 10, 40, -1);
+    CHECK(name, tm.softLimitMs() > 0);
+    CHECK(name, tm.softLimitMs() <= tm.hardLimitMs());
+    CHECK(name, tm.hardLimitMs() <= 10000 / 3 + 100);
+
+    tm.startMove(10000, 0, 10, 40, 150);
+    CHECK(name, tm.hardLimitMs() <= 150);
+}
+
+void testTimeManagerStability() {
+    const char* name = "testTimeManagerStability";
+    TimeManager tm;
+    tm.startMove(60000, 0, 0, 49, -1);
+    int soft = tm.softLimitMs();
+    tm.onIterationComplete(Coord(3, 3), 100, 200);
+    CHECK(name, tm.canStartIteration(soft - 1));
+    CHECK(name, !tm.canStartIteration(soft));
+
+    tm.onIterationComplete(Coord(3, 3), 100, 200);
+    tm.onIterationComplete(Coord(3, 3), 100, 200);
+    tm.onIterationComplete(Coord(3, 3), 100, 200);
+    CHECK(name, tm.stableIterations() >= TimeManager::STABLE_ITERATIONS);
+    CHECK(name, !tm.canStartIteration(soft * 3 / 4));
+
+    tm.onIterationComplete(Coord(2, 4), 100, 200);
+    CHECK(name, tm.stableIterations() == 0);
+    CHECK(name, tm.canStartIteration(soft * 5 / 4));
+
+    tm.onIterationComplete(Coord(2, 4), -500, 200);
+    CHECK(name, tm.canStartIteration(soft * 5 / 4));
+    CHECK(name, !tm.canStartIteration(tm.hardLimitMs()));
+}
+
+void testGameClockCharges() {
+    const char* name = "testGameClockCharges";
+    GameController gc(7, 7, 4, GameMode::Classic, OpeningRule::None);
+    CHECK(name, gc.remainingTimeMs(Seat::A) < 0);
+    gc.setTimeControl(5000, 50);
+    CHECK(name, gc.remainingTimeMs(Seat::A) == 5000);
+    CHECK(name, gc.remainingTimeMs(Seat::B) == 5000);
+    CHECK(name, gc.applyMove(3, 3) == MoveStatus::Ok);
+
+    AIStatistics stats;
+    MoveEvaluation eval = gc.findBestMoveForSeat(Seat::B, Player::O, 12, true, stats);
+    CHECK(name, eval.move.row() >= 0);
+    CHECK(name, stats.timeMs <= 5000 / 3 + 50 + 100);
+    CHECK(name, gc.remainingTimeMs(Seat::B) <= 5050);
+    CHECK(name, gc.remainingTimeMs(Seat::B) > 0);
+    CHECK(name, gc.remainingTimeMs(Seat::A) == 5000);
+
+    // A hint plays no move, so neither clock moves.
+    long long remainingB = gc.remainingTimeMs(Seat::B);
+    MoveEvaluation hint = gc.findBestMove(Player::O, 3, true, stats);
+    CHECK(name, hint.move.row() >= 0);
+    CHECK(name, gc.remainingTimeMs(Seat::A) == 5000);
+    CHECK(name, gc.remainingTimeMs(Seat::B) == remainingB);
+
+    gc.newGame(7, 7, 4, GameMode::Classic, OpeningRule::None);
+    CHECK(name, gc.remainingTimeMs(Seat::B) == 5000);
+}
+
+Board makeMidgameBoard() {
+    Board b(9, 9, 5);
+    b.set(4, 4, CellState::X);
+    b.set(4, 5, CellState::O);
+    b.set(3, 3, CellState::X);
+    b.set(5, 5, CellState::O);
+    return b;
+}
+
+void testNodeLimit() {
+    const char* name = "testNodeLimit";
+    const uint64_t limit = 20000;
+    for (int threads = 1; threads <= 4; threads += 3) {
+        Board b = makeMidgameBoard();
+        MinimaxAI ai(Player::X, 12, true, GameMode::Classic);
+        ai.setThreadBudget(threads);
+        ai.setNodeLimit(limit);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, eval.move.row() >= 0);
+        CHECK(name, st.nodeLimitHit);
+        CHECK(name, st.nodes <= limit);
+    }
+}
+
+void testDeadlinePolling() {
+    const char* name = "testDeadlinePolling";
+    Board b = makeMidgameBoard();
+    MinimaxAI ai(Player::X, 30, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    ai.setTimeLimitMs(150);
+    MoveEvaluation eval = ai.findBestMove(b);
+    const AIStatistics& st = ai.getStatistics();
+    CHECK(name, eval.move.row() >= 0);
+    CHECK(name, st.clockPolls > 0);
+    CHECK(name, st.clockPolls * 100 < st.nodes);
+    CHECK(name, st.timeMs < 150 + 250);
+    CHECK(name, st.stopLatencyMs < 250);
+}
+
+Board boardFromRows(const char* const* rowsText, int rows, int cols, int winLen) {
+    Board b(rows, cols, winLen);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (rowsText[r][c] == 'X') b.set(r, c, CellState::X);
+            else if (rowsText[r][c] == 'O') b.set(r, c, CellState::O);
+        }
+    }
+    return b;
+}
+
+// Every defender reply must be the only cell where the attacker would win next.
+bool replayForcedWin(Board b, const DynamicArray<Coord>& line, CellState att, CellState def) {
+    for (size_t i = 0; i < line.size(); ++i) {
+        const Coord& mv = line[i];
+        if (!b.isEmpty(mv)) return false;
+        if (i % 2 == 1) {
+            b.set(mv, att);
+            bool threat = b.checkWinFromMove(mv, att);
+            b.set(mv, CellState::Empty);
+            if (!threat) return false;
+            b.set(mv, def);
+        } else {
+            b.set(mv, att);
+        }
+    }
+    return !line.empty() && b.checkWinFromMove(line[line.size() - 1], att);
+}
+
+void testThreatSearchVCF() {
+    const char* name = "testThreatSearchVCF";
+    const char* rows[15] = {
+        "...............",
+        "...............",
+        "...............",
+        "...............",
+        "...............",
+        ".......X.XX....",
+        ".....XXO..X....",
+        ".....XO..XX....",
+        "......OXOO.....",
+        ".......O.......",
+        ".....O.O.OO....",
+        "...............",
+        "...............",
+        "...............",
+        "...............",
+    };
+    Board b = boardFromRows(rows, 15, 15, 5);
+
+    ThreatSearch ts(b);
+    DynamicArray<Coord> line;
+    CHECK(name, ts.findVCF(CellState::X, line));
+    CHECK(name, line.size() >= 9);
+    CHECK(name, replayForcedWin(b, line, CellState::X, CellState::O));
+
+    MinimaxAI ai(Player::X, 3, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    Board search = b;
+    MoveEvaluation eval = ai.findBestMove(search);
+    CHECK(name, ai.getStatistics().threatWin);
+    CHECK(name, eval.move == line[0]);
+    CHECK(name, eval.score > 0);
+
+    MoveEvaluation again = ai.findBestMove(search);
+    CHECK(name, again.move == eval.move);
+}
+
+void testThreatSearchRejectsDefendedPosition() {
+    const char* name = "testThreatSearchRejectsDefendedPosition";
+    Board b = makeMidgameBoard();
+    ThreatSearch ts(b);
+    DynamicArray<Coord> line;
+    CHECK(name, !ts.findVCF(CellState::X, line));
+    CHECK(name, !ts.findVCT(CellState::X, line));
+    CHECK(name, ts.nodes() > 0);
+}
+
+// A VCT line is not proven, so it only orders the root moves.
+void testThreatSearchVctOnlyOrders() {
+    const char* name = "testThreatSearchVctOnlyOrders";
+    Board b(15, 15, 5);
+    b.set(7, 6, CellState::X);
+    b.set(7, 7, CellState::X);
+    b.set(8, 8, CellState::X);
+    b.set(9, 8, CellState::X);
+    b.set(0, 0, CellState::O);
+    b.set(0, 14, CellState::O);
+    b.set(14, 0, CellState::O);
+    b.set(14, 14, CellState::O);
+    ThreatSearch ts(b);
+    DynamicArray<Coord> line;
+    CHECK(name, !ts.findVCF(CellState::X, line));
+    CHECK(name, ts.findVCT(CellState::X, line));
+
+    MinimaxAI ai(Player::X, 3, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    MoveEvaluation eval = ai.findBestMove(b);
+    CHECK(name, !ai.getStatistics().threatWin);
+    CHECK(name, ai.getStatistics().completedDepth == 3);
+    CHECK(name, eval.move.row() >= 0 && b.isEmpty(eval.move));
+}
+
+void testProofNumberOutcomes() {
+    const char* name = "testProofNumberOutcomes";
+    Coord mv;
+    ProofNumberSearch draw3(Board(3, 3, 3));
+    CHECK(name, draw3.solve(CellState::X, mv) == ProofOutcome::Draw);
+    CHECK(name, mv.row() >= 0);
+
+    ProofNumberSearch win43(Board(4, 4, 3));
+    CHECK(name, win43.solve(CellState::X, mv) == ProofOutcome::Win);
+    Board afterWin(4, 4, 3);
+    afterWin.set(mv, CellState::X);
+    ProofNumberSearch replyLoses(afterWin);
+    Coord reply;
+    CHECK(name, replyLoses.solve(CellState::O, reply) == ProofOutcome::Loss);
+
+    ProofNumberSearch draw44(Board(4, 4, 4));
+    CHECK(name, draw44.solve(CellState::X, mv) == ProofOutcome::Draw);
+
+    ProofNumberSearch bounded(Board(3, 3, 3));
+    bounded.setMaxEntries(512);
+    CHECK(name, bounded.solve(CellState::X, mv) == ProofOutcome::Draw);
+    CHECK(name, bounded.tableSize() <= 512);
+
+    // Small tables replace entries heavily; a reported win still comes with a proven move.
+    for (size_t entries = 64; entries <= 1024; entries *= 2) {
+        ProofNumberSearch small(Board(5, 5, 3));
+        small.setMaxEntries(entries);
+        small.setNodeBudget(200000);
+        ProofOutcome outcome = small.solve(CellState::X, mv);
+        CHECK(name, outcome == ProofOutcome::Win || outcome == ProofOutcome::Unknown);
+        if (outcome == ProofOutcome::Win) {
+            Board after(5, 5, 3);
+            after.set(mv, CellState::X);
+            ProofNumberSearch check(after);
+            CHECK(name, check.solve(CellState::O, reply) == ProofOutcome::Loss);
+        }
+    }
+
+    std::atomic<bool> cancel(true);
+    ProofNumberSearch cancelled(Board(4, 4, 4));
+    cancelled.setCancelFlag(&cancel);
+    CHECK(name, cancelled.solve(CellState::X, mv) == ProofOutcome::Unknown);
+}
+
+void testProofOracleInFindBestMove() {
+    const char* name = "testProofOracleInFindBestMove";
+    const char* rows[5] = {
+        "X....",
+        ".O.O.",
+        ".OXX.",
+        "..XO.",
+        "....X",
+    };
+    Board b = boardFromRows(rows, 5, 5, 4);
+    MinimaxAI ai(Player::O, 2, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    MoveEvaluation eval = ai.findBestMove(b);
+    const AIStatistics& st = ai.getStatistics();
+    CHECK(name, st.proofOutcome == ProofOutcome::Win);
+    CHECK(name, st.proofNodes > 0);
+    CHECK(name, eval.move.row() >= 0);
+    b.set(eval.move, CellState::O);
+    ProofNumberSearch after(b);
+    Coord reply;
+    CHECK(name, after.solve(CellState::X, reply) == ProofOutcome::Loss);
+
+    MinimaxAI off(Player::O, 2, true, GameMode::Classic);
+    off.setProofThreshold(0);
+    Board again = boardFromRows(rows, 5, 5, 4);
+    off.findBestMove(again);
+    CHECK(name, off.getStatistics().proofOutcome == ProofOutcome::Unknown);
+}
+
+int bruteLinesDiff(Board& b, CellState side) {
+    if (b.isFull()) return 0;
+    CellState opp = (side == CellState::X) ? CellState::O : CellState::X;
+    int best = std::numeric_limits<int>::min();
+    for (int r = 0; r < b.getRows(); ++r) {
+        for (int c = 0; c < b.getCols(); ++c) {
+            if (!b.isEmpty(r, c)) continue;
+            b.set(r, c, side);
+            int gained = std::min(2, b.countLinesFromMove(Coord(r, c), side));
+            int v = gained - bruteLinesDiff(b, opp);
+            b.set(r, c, CellState::Empty);
+            best = std::max(best, v);
+        }
+    }
+    return best;
+}
+
+Board randomEndgame(std::mt19937& rng, int rows, int cols, int winLen, int empties, CellState& toMove) {
+    Board b(rows, cols, winLen);
+    toMove = CellState::X;
+    for (int i = 0; i < rows * cols - empties; ++i) {
+        int r = 0;
+        int c = 0;
+        do {
+            r = static_cast<int>(rng() % static_cast<unsigned>(rows));
+            c = static_cast<int>(rng() % static_cast<unsigned>(cols));
+        } while (!b.isEmpty(r, c));
+        b.set(r, c, toMove);
+        toMove = (toMove == CellState::X) ? CellState::O : CellState::X;
+    }
+    return b;
+}
+
+void testLinesEndgameMatchesBruteForce() {
+    const char* name = "testLinesEndgameMatchesBruteForce";
+    std::mt19937 rng(11);
+    for (int i = 0; i < 40; ++i) {
+        CellState toMove;
+        Board b = randomEndgame(rng, 5, 5, 3 + i % 2, 8, toMove);
+        CHECK(name, b.emptyCount() == 8);
+        LinesEndgameSolver solver(b);
+        int diff = 0;
+        Coord mv;
+        CHECK(name, solver.solve(toMove, diff, mv));
+        int expected = bruteLinesDiff(b, toMove);
+        CHECK(name, diff == expected);
+        b.set(mv, toMove);
+        CellState opp = (toMove == CellState::X) ? CellState::O : CellState::X;
+        CHECK(name, std::min(2, b.countLinesFromMove(mv, toMove)) - bruteLinesDiff(b, opp) == expected);
+    }
+}
+
+void testLinesEndgameInFindBestMove() {
+    const char* name = "testLinesEndgameInFindBestMove";
+    std::mt19937 rng(5);
+    CellState toMove;
+    Board b = randomEndgame(rng, 7, 7, 4, 14, toMove);
+    Player side = (toMove == CellState::X) ? Player::X : Player::O;
+    MinimaxAI ai(side, 4, true, GameMode::LinesScore);
+    ai.setCredits(3, 5);
+    Board search = b;
+    MoveEvaluation eval = ai.findBestMove(search);
+    const AIStatistics& st = ai.getStatistics();
+    CHECK(name, st.endgameExact);
+    CHECK(name, st.endgameNodes > 0);
+
+    LinesEndgameSolver solver(b);
+    int diff = 0;
+    Coord mv;
+    CHECK(name, solver.solve(toMove, diff, mv));
+    int base = (side == Player::X) ? (3 - 5) : (5 - 3);
+    CHECK(name, eval.score == (base + diff) * 1000);
+
+    MinimaxAI off(side, 2, true, GameMode::LinesScore);
+    off.setEndgameThreshold(0);
+    Board again = b;
+    off.findBestMove(again);
+    CHECK(name, !off.getStatistics().endgameExact);
+}
+
+void testLineBoundsPruning() {
+    const char* name = "testLineBoundsPruning";
+    Board empty(3, 3, 3);
+    CHECK(name, empty.liveWindowCount(CellState::X) == 8);
+    empty.set(1, 1, CellState::X);
+    CHECK(name, empty.liveWindowCount(CellState::X) == 8);
+    CHECK(name, empty.liveWindowCount(CellState::O) == 4);
+
+    std::mt19937 rng(2);
+    CellState toMove;
+    Board b = randomEndgame(rng, 7, 7, 4, 12, toMove);
+    Player side = (toMove == CellState::X) ? Player::X : Player::O;
+    MinimaxAI on(side, 8, true, GameMode::LinesScore);
+    on.setEndgameThreshold(0);
+    Board first = b;
+    MoveEvaluation a = on.findBestMove(first);
+    AIStatistics sa = on.getStatistics();
+    MinimaxAI off(side, 8, true, GameMode::LinesScore);
+    off.setEndgameThreshold(0);
+    off.setUseLineBounds(false);
+    Board second = b;
+    off.findBestMove(second);
+    AIStatistics sb = off.getStatistics();
+    CHECK(name, a.move.row() >= 0 && b.isEmpty(a.move));
+    CHECK(name, sa.boundCutoffs > 0);
+    CHECK(name, sb.boundCutoffs == 0);
+    CHECK(name, sa.nodes < sb.nodes);
+}
+
+void testLinesEarlyFinish() {
+    const char* name = "testLinesEarlyFinish";
+    int early = 0;
+    for (unsigned seed = 1; seed <= 30; ++seed) {
+        std::mt19937 rng(seed);
+        GameController gc(4, 4, 3, GameMode::LinesScore, OpeningRule::None);
+        gc.setEarlyFinish(true);
+        while (!gc.isGameOver()) {
+            Board cur = gc.boardSnapshot();
+            DynamicArray<Coord> cells = cur.getEmptyCells();
+            Coord mv = cells[rng() % cells.size()];
+            gc.applyMove(mv.row(), mv.col());
+        }
+        if (!gc.finishedEarly()) {
+            CHECK(name, gc.boardSnapshot().isFull());
+            continue;
+        }
+        ++early;
+        Board end = gc.boardSnapshot();
+        CHECK(name, !end.isFull());
+        CellState toMove = (gc.currentPlayer() == Player::X) ? CellState::X : CellState::O;
+        LinesEndgameSolver solver(end);
+        int future = 0;
+        Coord best;
+        CHECK(name, solver.solve(toMove, future, best));
+        int finalScore = gc.score() + (toMove == CellState::O ? future : -future);
+        CHECK(name, (finalScore > 0) == (gc.score() > 0));
+        CHECK(name, (finalScore < 0) == (gc.score() < 0));
+    }
+    CHECK(name, early > 0);
+}
+
+void testClassicDeadDraw() {
+    const char* name = "testClassicDeadDraw";
+    const char* rows[] = { "XO.X", "OXO.", "..OX", "..XO" };
+    Board b = boardFromRows(rows, 4, 4, 4);
+    CHECK(name, b.liveWindowCount(CellState::X) == 0);
+    CHECK(name, b.liveWindowCount(CellState::O) == 0);
+    MinimaxAI ai(Player::X, 6, true, GameMode::Classic);
+    ai.setProofThreshold(0);
+    ai.setUseThreatSearch(false);
+    ai.setThreadBudget(1);
+    MoveEvaluation eval = ai.findBestMove(b);
+    CHECK(name, eval.move.row() >= 0);
+    CHECK(name, eval.score == 0);
+    CHECK(name, ai.getStatistics().deadDrawCutoffs > 0);
+    CHECK(name, ai.getStatistics().nodes < 50);
+
+    const int moves[10][2] = { {0,0}, {0,1}, {0,3}, {1,0}, {1,1}, {1,2}, {2,3}, {2,2}, {3,2}, {3,3} };
+    GameController gc(4, 4, 4, GameMode::Classic, OpeningRule::None);
+    gc.setEarlyFinish(true);
+    for (int i = 0; i < 10 && !gc.isGameOver(); ++i) {
+        CHECK(name, gc.applyMove(moves[i][0], moves[i][1]) == MoveStatus::Ok);
+    }
+    CHECK(name, gc.isGameOver());
+    CHECK(name, gc.finishedEarly());
+    Board end = gc.boardSnapshot();
+    CHECK(name, !end.isFull());
+    CHECK(name, !end.checkWin(CellState::X) && !end.checkWin(CellState::O));
+}
+
+void testDeadCellsPruned() {
+    const char* name = "testDeadCellsPruned";
+    uint64_t pruned = 0;
+    uint64_t nodesOn = 0;
+    uint64_t nodesOff = 0;
+    for (unsigned seed = 1; seed <= 6; ++seed) {
+        std::mt19937 rng(seed);
+        CellState toMove;
+        Board b = randomEndgame(rng, 5, 5, 4, 10, toMove);
+        Player side = (toMove == CellState::X) ? Player::X : Player::O;
+        int scores[2] = { 0, 0 };
+        for (int on = 0; on < 2; ++on) {
+            MinimaxAI ai(side, 10, true, GameMode::Classic);
+            ai.setThreadBudget(1);
+            ai.setProofThreshold(0);
+            ai.setUseThreatSearch(false);
+            ai.setDropDeadCells(on == 1);
+            Board search = b;
+            scores[on] = ai.findBestMove(search).score;
+            const AIStatistics& st = ai.getStatistics();
+            if (on == 1) {
+                pruned += st.deadCellsPruned;
+                nodesOn += st.nodes;
+            } else {
+                CHECK(name, st.deadCellsPruned == 0);
+                nodesOff += st.nodes;
+            }
+        }
+        CHECK(name, scores[0] == scores[1]);
+    }
+    CHECK(name, pruned > 0);
+    CHECK(name, nodesOn < nodesOff);
+}
+
+void testClassicForcedBlock() {
+    const char* name = "testClassicForcedBlock";
+    const char* rows[] = {
+        ".........",
+        ".......X.",
+        "..X......",
+        ".........",
+        "XOOOO....",
+        ".........",
+        "......X..",
+        ".........",
+        "........."
+    };
+    uint64_t nodes[2] = { 0, 0 };
+    for (int on = 0; on < 2; ++on) {
+        Board b = boardFromRows(rows, 9, 9, 5);
+        MinimaxAI ai(Player::X, 4, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setClassicMustPlay(on == 1);
+        MoveEvaluation eval = ai.findBestMove(b);
+        CHECK(name, eval.move == Coord(4, 5));
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, (st.forcedMoveNodes > 0) == (on == 1));
+        nodes[on] = st.nodes;
+    }
+    CHECK(name, nodes[1] < nodes[0]);
+}
+
+void testQuiescenceSeesHorizonWin() {
+    const char* name = "testQuiescenceSeesHorizonWin";
+    const char* rows[] = {
+        ".........",
+        "......O..",
+        ".........",
+        ".........",
+        "..XXX....",
+        ".........",
+        "..O...O..",
+        ".........",
+        "........."
+    };
+    for (int on = 0; on < 2; ++on) {
+        Board b = boardFromRows(rows, 9, 9, 5);
+        MinimaxAI ai(Player::X, 1, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setUseQuiescence(on == 1);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        if (on == 1) {
+            CHECK(name, eval.score > 1000000000 / 2);
+            // Open four at the root, forced block, five two plies past the horizon.
+            CHECK(name, eval.score == 1000000000 - 2);
+            CHECK(name, eval.move == Coord(4, 1) || eval.move == Coord(4, 5));
+            CHECK(name, st.quiescenceNodes > 0);
+        } else {
+            CHECK(name, eval.score < 1000000000 / 2);
+            CHECK(name, st.quiescenceNodes == 0);
+        }
+    }
+
+    Board b = boardFromRows(rows, 9, 9, 5);
+    MinimaxAI capped(Player::X, 3, true, GameMode::Classic);
+    capped.setThreadBudget(1);
+    capped.setUseThreatSearch(false);
+    capped.setQuiescenceLimits(4, 50);
+    capped.findBestMove(b);
+    CHECK(name, capped.getStatistics().quiescenceNodes <= 50 + 4);
+}
+
+void testNullMoveAndProbCut() {
+    const char* name = "testNullMoveAndProbCut";
+    const char* rows[] = {
+        ".........",
+        ".........",
+        "...O.....",
+        "...XX.O..",
+        "....OX...",
+        "...X.O...",
+        ".....X...",
+        "....O....",
+        "........."
+    };
+    uint64_t baseNodes = 0;
+    Coord baseMove(-1, -1);
+    for (int mask = 0; mask < 4; ++mask) {
+        Board b = boardFromRows(rows, 9, 9, 5);
+        MinimaxAI ai(Player::X, 6, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setUseNullMove((mask & 1) != 0);
+        ai.setUseProbCut((mask & 2) != 0);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, b.isEmpty(eval.move.row(), eval.move.col()));
+        CHECK(name, (st.nullMoveTries > 0) == ((mask & 1) != 0));
+        CHECK(name, (st.probCutTries > 0) == ((mask & 2) != 0));
+        if (mask == 0) {
+            baseNodes = st.nodes;
+            baseMove = eval.move;
+            continue;
+        }
+        CHECK(name, eval.move == baseMove);
+        if (mask & 1) {
+            CHECK(name, st.nullMoveCutoffs > 0);
+            CHECK(name, st.nodes < baseNodes);
+        }
+    }
+}
+
+void testShallowPruning() {
+    const char* name = "testShallowPruning";
+    const char* classic[] = {
+        ".........",
+        ".........",
+        "...O.....",
+        "...XX.O..",
+        "....OX...",
+        "...X.O...",
+        ".....X...",
+        "....O....",
+        "........."
+    };
+    const char* lines[] = {
+        ".......",
+        "....OX.",
+        "....O..",
+        "..O....",
+        "..X....",
+        "..X....",
+        "......."
+    };
+    for (int pos = 0; pos < 2; ++pos) {
+        uint64_t nodes[2] = { 0, 0 };
+        for (int on = 0; on < 2; ++on) {
+            Board b = (pos == 0) ? boardFromRows(classic, 9, 9, 5) : boardFromRows(lines, 7, 7, 4);
+            MinimaxAI ai(Player::X, 6, true, (pos == 0) ? GameMode::Classic : GameMode::LinesScore);
+            ai.setThreadBudget(1);
+            ai.setUseThreatSearch(false);
+            ai.setUseShallowPruning(on == 1);
+            MoveEvaluation eval = ai.findBestMove(b);
+            const AIStatistics& st = ai.getStatistics();
+            CHECK(name, b.isEmpty(eval.move.row(), eval.move.col()));
+            uint64_t pruned = 0;
+            for (int d = 1; d <= 3; ++d) pruned += st.futilityPruned[d] + st.lateMovePruned[d];
+            CHECK(name, (pruned > 0) == (on == 1));
+            CHECK(name, st.futilityPruned[0] == 0 && st.lateMovePruned[0] == 0);
+            nodes[on] = st.nodes;
+        }
+        CHECK(name, nodes[1] < nodes[0]);
+    }
+}
+
+void testStagedMovePicker() {
+    const char* name = "testStagedMovePicker";
+    for (int mode = 0; mode < 2; ++mode) {
+        Board b = (mode == 0) ? makeMidgameBoard() : Board(7, 7, 4);
+        if (mode == 1) {
+            b.set(3, 3, CellState::X);
+            b.set(2, 3, CellState::O);
+            b.set(3, 4, CellState::X);
+            b.set(4, 2, CellState::O);
+        }
+        MinimaxAI ai(Player::X, 5, true, (mode == 0) ? GameMode::Classic : GameMode::LinesScore);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, b.isEmpty(eval.move.row(), eval.move.col()));
+        CHECK(name, st.stagedCutoffs > 0);
+    }
+
+    // Uncapped node after a search filled the killer, counter and follow-up
+    // tables: the TT, killer and quiet stages together yield every generated
+    // move exactly once.
+    Board small(7, 7, 4);
+    small.set(3, 3, CellState::X);
+    small.set(2, 3, CellState::O);
+    small.set(3, 4, CellState::X);
+    small.set(4, 2, CellState::O);
+    MinimaxAI ai(Player::X, 4, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    ai.setUseThreatSearch(false);
+    ai.findBestMove(small);
+    DynamicArray<Coord> generated;
+    DynamicArray<Coord> mustPlay;
+    size_t cap = 0;
+    ai.stagedOrder(small, 1, Player::X, Coord(-1, -1), generated, mustPlay, cap);
+    // One TT hint from the list, one outside it (searched on top of the list).
+    Coord hints[2] = { generated[generated.size() - 1], Coord(0, 6) };
+    for (int depth = 1; depth <= 3; ++depth) {
+        for (int h = 0; h < 2; ++h) {
+            DynamicArray<Coord> order = ai.stagedOrder(small, depth, Player::X, hints[h], generated, mustPlay, cap);
+            CHECK(name, order.size() == generated.size() + static_cast<size_t>(h));
+            bool once = true;
+            for (size_t i = 0; i < generated.size(); ++i) {
+                int seen = 0;
+                for (size_t j = 0; j < order.size(); ++j) seen += (order[j] == generated[i]);
+                once = once && seen == 1;
+            }
+            CHECK(name, once);
+            CHECK(name, !order.empty() && order[0] == hints[h]);
+        }
+    }
+
+    // A capped 15x15 node: no duplicates, and every must-play move is still yielded.
+    Board wide(15, 15, 5);
+    uint64_t rng = 7;
+    CellState side = CellState::X;
+    for (int i = 0; i < 30; ++i) {
+        int r;
+        int c;
+        do {
+            rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+            r = 3 + static_cast<int>((rng >> 33) % 9);
+            c = 3 + static_cast<int>((rng >> 45) % 9);
+        } while (!wide.isEmpty(r, c));
+        wide.set(r, c, side);
+        side = (side == CellState::X) ? CellState::O : CellState::X;
+    }
+    MinimaxAI lines(Player::X, 4, true, GameMode::LinesScore);
+    DynamicArray<Coord> order = lines.stagedOrder(wide, 4, Player::X, Coord(-1, -1), generated, mustPlay, cap);
+    CHECK(name, cap < generated.size() && !mustPlay.empty());
+    CHECK(name, order.size() >= cap && order.size() < generated.size());
+    bool unique = true;
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (size_t j = i + 1; j < order.size(); ++j) unique = unique && !(order[i] == order[j]);
+    }
+    CHECK(name, unique);
+    bool allMustPlay = true;
+    for (size_t i = 0; i < mustPlay.size(); ++i) {
+        bool found = false;
+        for (size_t j = 0; j < order.size(); ++j) found = found || order[j] == mustPlay[i];
+        allMustPlay = allMustPlay && found;
+    }
+    CHECK(name, allMustPlay);
+}
+
+void testOrderCache() {
+    const char* name = "testOrderCache";
+    MoveEvaluation results[2];
+    for (int on = 0; on < 2; ++on) {
+        Board b = makeMidgameBoard();
+        MinimaxAI ai(Player::X, 5, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setUseOrderCache(on == 1);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, b.isEmpty(eval.move.row(), eval.move.col()));
+        if (on == 1) {
+            CHECK(name, st.orderCacheHits > 0);
+            CHECK(name, st.orderCacheMisses > st.orderCacheHits);
+        } else {
+            CHECK(name, st.orderCacheHits == 0 && st.orderCacheMisses == 0);
+        }
+        results[on] = eval;
+    }
+    // The cache only saves work: the search must reach the same answer without it.
+    CHECK(name, results[0].move == results[1].move);
+    CHECK(name, results[0].score == results[1].score);
+}
+
+void testPersistentHistory() {
+    const char* name = "testPersistentHistory";
+    Board b = makeMidgameBoard();
+    MinimaxAI ai(Player::X, 5, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    ai.setUseThreatSearch(false);
+    MoveEvaluation first = ai.findBestMove(b);
+    int h1 = ai.historyScore(Player::X, first.move);
+    CHECK(name, h1 > 0);
+    bool anyCounter = false;
+    for (int r = 0; r < 9 && !anyCounter; ++r) {
+        for (int c = 0; c < 9; ++c) {
+            if (ai.counterMove(Player::X, Coord(r, c)).row() >= 0 || ai.counterMove(Player::O, Coord(r, c)).row() >= 0) {
+                anyCounter = true;
+                break;
+            }
+        }
+    }
+    CHECK(name, anyCounter);
+
+    ai.setMaxDepth(1);
+    Board same = makeMidgameBoard();
+    ai.findBestMove(same);
+    int h2 = ai.historyScore(Player::X, first.move);
+    CHECK(name, h2 >= h1 / 2 && h2 < h1);
+
+    ai.clearCache();
+    ai.findBestMove(same);
+    CHECK(name, ai.historyScore(Player::X, first.move) <= 1);
+}
+
+void testEvalCache() {
+    const char* name = "testEvalCache";
+    for (int mode = 0; mode < 2; ++mode) {
+        MoveEvaluation evals[2];
+        uint64_t nodes[2] = { 0, 0 };
+        for (int on = 0; on < 2; ++on) {
+            Board b = (mode == 0) ? makeMidgameBoard() : Board(7, 7, 4);
+            if (mode == 1) {
+                b.set(3, 3, CellState::X);
+                b.set(2, 3, CellState::O);
+                b.set(3, 4, CellState::X);
+            }
+            MinimaxAI ai(Player::O, 5, true, (mode == 0) ? GameMode::Classic : GameMode::LinesScore);
+            ai.setThreadBudget(1);
+            ai.setUseThreatSearch(false);
+            ai.setUseEvalCache(on == 1);
+            evals[on] = ai.findBestMove(b);
+            const AIStatistics& st = ai.getStatistics();
+            nodes[on] = st.nodes;
+            if (on == 1) {
+                CHECK(name, st.evalCacheHits > 0);
+                CHECK(name, st.evalCacheMisses > 0);
+            } else {
+                CHECK(name, st.evalCacheHits == 0 && st.evalCacheMisses == 0);
+            }
+        }
+        CHECK(name, evals[0].move == evals[1].move);
+        CHECK(name, evals[0].score == evals[1].score);
+        CHECK(name, nodes[0] == nodes[1]);
+    }
+}
+
+void testPatternEval() {
+    const char* name = "testPatternEval";
+    Board b(11, 11, 5);
+    b.set(5, 4, CellState::X);
+    b.set(5, 5, CellState::X);
+    b.set(5, 6, CellState::X);
+    b.set(2, 4, CellState::X);
+    b.set(2, 5, CellState::X);
+    b.set(2, 6, CellState::X);
+    b.set(2, 3, CellState::O);
+    b.set(8, 8, CellState::O);
+    b.set(9, 1, CellState::O);
+    b.set(0, 10, CellState::O);
+
+    MoveEvaluation evals[2];
+    for (int cache = 0; cache < 2; ++cache) {
+        MinimaxAI ai(Player::O, 1, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setUseEvalCache(cache == 1);
+        ai.setEvalBackend(EvalBackend::Patterns);
+        evals[cache] = ai.findBestMove(b);
+    }
+    // The open three is the one to block; the capped one can wait.
+    CHECK(name, evals[1].move.row() == 5);
+    CHECK(name, evals[1].move.col() == 3 || evals[1].move.col() == 7);
+    CHECK(name, evals[0].move == evals[1].move && evals[0].score == evals[1].score);
+
+    // Switching back must not reuse scores stored by the other evaluator.
+    MinimaxAI windows(Player::O, 3, true, GameMode::LinesScore);
+    windows.setThreadBudget(1);
+    Board lines = makeMidgameBoard();
+    MoveEvaluation fresh = windows.findBestMove(lines);
+    MinimaxAI switched(Player::O, 3, true, GameMode::LinesScore);
+    switched.setThreadBudget(1);
+    switched.setEvalBackend(EvalBackend::Patterns);
+    MoveEvaluation patterned = switched.findBestMove(lines);
+    CHECK(name, patterned.move.row() >= 0);
+    switched.setEvalBackend(EvalBackend::Windows);
+    MoveEvaluation back = switched.findBestMove(lines);
+    CHECK(name, back.move == fresh.move && back.score == fresh.score);
+
+    // Pruning margins are in window weights, so under patterns they must not change the result.
+    Board sparse(7, 7, 5);
+    sparse.set(2, 0, CellState::X);
+    sparse.set(5, 6, CellState::O);
+    sparse.set(6, 0, CellState::X);
+    sparse.set(0, 2, CellState::O);
+    sparse.set(5, 2, CellState::X);
+    sparse.set(2, 1, CellState::O);
+    sparse.set(3, 1, CellState::X);
+    sparse.set(1, 0, CellState::O);
+    sparse.set(1, 5, CellState::X);
+    MoveEvaluation pruned[2];
+    for (int on = 0; on < 2; ++on) {
+        MinimaxAI ai(Player::X, 4, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setEvalBackend(EvalBackend::Patterns);
+        ai.setUseShallowPruning(on == 1);
+        ai.setUseProbCut(on == 1);
+        pruned[on] = ai.findBestMove(sparse);
+    }
+    CHECK(name, pruned[0].move == pruned[1].move && pruned[0].score == pruned[1].score);
+
+    SearchParams params(2, true);
+    params.setEvalBackend(EvalBackend::Patterns);
+    AnalysisResult r = analysePosition(b, Player::O, GameMode::Classic, params);
+    CHECK(name, r.bestMove.row() == 5);
+}
+
+void testNeuralEval() {
+    const char* name = "testNeuralEval";
+    Board b(7, 7, 4);
+    b.set(3, 3, CellState::X);
+    b.set(3, 4, CellState::O);
+
+    // One unit that fires when X holds (2, 2): the search should go straight there.
+    NeuralNet net;
+    net.init(7, 7, 4, GameMode::Classic, 16, 0);
+    CHECK(name, net.hidden() == 16);
+    net.weight(NeuralNet::feature(2 * 7 + 2, CellState::X), 0) = 100;
+    net.outputWeight(0) = 1000;
+    std::string path = (std::filesystem::temp_directory_path() / "tictactoe2_eval_test.nnue").string();
+    CHECK(name, net.save(path));
+    NeuralNet loaded;
+    CHECK(name, loaded.load(path));
+    CHECK(name, loaded.matches(7, 7, 4, GameMode::Classic));
+    CHECK(name, !loaded.matches(7, 7, 4, GameMode::LinesScore));
+    CHECK(name, !loaded.load(path + ".missing"));
+    CHECK(name, loaded.hidden() == 16);
+
+    MoveEvaluation evals[2];
+    for (int cache = 0; cache < 2; ++cache) {
+        MinimaxAI ai(Player::X, 3, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setUseEvalCache(cache == 1);
+        ai.setNeuralNet(&loaded);
+        ai.setEvalBackend(EvalBackend::Neural);
+        evals[cache] = ai.findBestMove(b);
+    }
+    CHECK(name, evals[1].move == Coord(2, 2));
+    CHECK(name, evals[0].move == evals[1].move && evals[0].score == evals[1].score);
+
+    // Pruning margins are in window weights, so a network on its own (much larger)
+    // scale must get the same answer with pruning on and off.
+    NeuralNet wide;
+    wide.init(7, 7, 4, GameMode::Classic, 16, 0);
+    uint32_t seed = 3 * 97u;
+    for (int f = 0; f < 98; ++f) {
+        for (int j = 0; j < 16; ++j) {
+            seed = seed * 1664525u + 1013904223u;
+            wide.weight(f, j) = static_cast<int16_t>(static_cast<int>((seed >> 16) % 255) - 127);
+        }
+    }
+    for (int j = 0; j < 16; ++j) {
+        seed = seed * 1664525u + 1013904223u;
+        wide.outputWeight(j) = static_cast<int16_t>(static_cast<int>((seed >> 16) % 60001) - 30000);
+    }
+    Board scattered(7, 7, 4);
+    seed = 6 * 2654435761u;
+    for (int i = 0; i < 8; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int cell = static_cast<int>((seed >> 8) % 49);
+        if (scattered.isEmpty(cell / 7, cell % 7)) scattered.set(cell / 7, cell % 7, (i & 1) ? CellState::O : CellState::X);
+    }
+    MoveEvaluation pruned[2];
+    for (int on = 0; on < 2; ++on) {
+        MinimaxAI ai(Player::X, 5, true, GameMode::Classic);
+        ai.setThreadBudget(1);
+        ai.setUseThreatSearch(false);
+        ai.setNeuralNet(&wide);
+        ai.setEvalBackend(EvalBackend::Neural);
+        ai.setUseShallowPruning(on == 1);
+        ai.setUseProbCut(on == 1);
+        pruned[on] = ai.findBestMove(scattered);
+    }
+    CHECK(name, pruned[0].move == pruned[1].move && pruned[0].score == pruned[1].score);
+
+    // A network for another geometry is ignored in favour of the window evaluator.
+    MinimaxAI windows(Player::O, 3, true, GameMode::LinesScore);
+    windows.setThreadBudget(1);
+    Board lines = makeMidgameBoard();
+    MoveEvaluation expected = windows.findBestMove(lines);
+    MinimaxAI fallback(Player::O, 3, true, GameMode::LinesScore);
+    fallback.setThreadBudget(1);
+    fallback.setNeuralNet(&loaded);
+    fallback.setEvalBackend(EvalBackend::Neural);
+    MoveEvaluation got = fallback.findBestMove(lines);
+    CHECK(name, got.move == expected.move && got.score == expected.score);
+
+    GameController gc(7, 7, 4, GameMode::Classic);
+    CHECK(name, !gc.loadEvalWeights(path + ".missing"));
+    CHECK(name, gc.loadEvalWeights(path));
+    CHECK(name, gc.hasEvalWeights());
+    std::filesystem::remove(path);
+}
+
+void testEvalWeights() {
+    const char* name = "testEvalWeights";
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string weightsPath = (dir / "tictactoe2_weights_test.txt").string();
+    std::string dumpPath = (dir / "tictactoe2_positions_test.txt").string();
+    std::filesystem::remove(dumpPath);
+
+    // A big bonus on (2, 2) must pull the search there.
+    EvalWeights tuned = EvalWeights::defaults(7, 7, 4, GameMode::Classic, 0);
+    tuned.cells[2 * 7 + 2] = 5000;
+    EvalWeightSet set;
+    set.set(tuned);
+    set.set(EvalWeights::defaults(6, 6, 4, GameMode::LinesScore, 0));
+    CHECK(name, set.size() == 2);
+    CHECK(name, set.save(weightsPath));
+    EvalWeightSet loaded;
+    CHECK(name, loaded.load(weightsPath));
+    CHECK(name, loaded.size() == 2);
+    const EvalWeights* found = loaded.find(7, 7, 4, GameMode::Classic);
+    CHECK(name, found && found->cells[2 * 7 + 2] == 5000 && found->window[3] == tuned.window[3]);
+    CHECK(name, !loaded.find(7, 7, 4, GameMode::LinesScore));
+    CHECK(name, !loaded.load(weightsPath + ".missing"));
+
+    // Zero, negative, non-increasing or line-sized window weights are rejected and
+    // change nothing; 62500000 is the engine's complete window here.
+    std::string badPath = (dir / "tictactoe2_bad_weights_test.txt").string();
+    CHECK(name, EvalWeights::completeWindow(4, GameMode::Classic) == 62500000);
+    CHECK(name, EvalWeights::completeWindow(4, GameMode::LinesScore) == 2320);
+    const char* badWindows[] = { "0 20 40", "-5 20 40", "10 30 30", "10 40 20", "10 20 62500000" };
+    for (const char* window : badWindows) {
+        std::ofstream bad(badPath, std::ios::trunc);
+        bad << "weights 7 7 4 classic\nwindow " << window << "\ncells";
+        for (int i = 0; i < 49; ++i) bad << " 1";
+        bad << "\n";
+        bad.close();
+        EvalWeightSet rejected;
+        CHECK(name, !rejected.load(badPath));
+        CHECK(name, rejected.empty());
+        CHECK(name, !loaded.load(badPath));
+        CHECK(name, loaded.find(7, 7, 4, GameMode::Classic)->cells[2 * 7 + 2] == 5000);
+    }
+    {
+        std::ofstream bad(badPath, std::ios::trunc);
+        bad << "weights 6 6 4 lines\nwindow 10 20 2320\ncells";
+        for (int i = 0; i < 36; ++i) bad << " 1";
+        bad << "\n";
+    }
+    CHECK(name, !loaded.load(badPath));
+    {
+        std::ofstream bad(badPath, std::ios::trunc);
+        bad << "weights 100000 100000 4 classic\nwindow 10 20 40\ncells 1\n";
+    }
+    CHECK(name, !loaded.load(badPath));
+    {
+        std::ofstream good(badPath, std::ios::trunc);
+        good << "weights 6 6 4 lines\nwindow 10 20 2319\ncells";
+        for (int i = 0; i < 36; ++i) good << " 1";
+        good << "\n";
+    }
+    EvalWeightSet edge;
+    CHECK(name, edge.load(badPath) && edge.find(6, 6, 4, GameMode::LinesScore)->window[3] == 2319);
+    std::filesystem::remove(badPath);
+
+    Board b(7, 7, 4);
+    b.set(3, 3, CellState::X);
+    b.set(3, 4, CellState::O);
+    MinimaxAI ai(Player::X, 1, true, GameMode::Classic);
+    ai.setThreadBudget(1);
+    ai.setUseThreatSearch(false);
+    MoveEvaluation plain = ai.findBestMove(b);
+    CHECK(name, plain.move != Coord(2, 2));
+    ai.setEvalWeights(&loaded);
+    MoveEvaluation pulled = ai.findBestMove(b);
+    CHECK(name, pulled.move == Coord(2, 2));
+
+    TuningPosition p = TuningPosition::fromBoard(b, GameMode::LinesScore, 2, 1);
+    p.result = 0.5;
+    TuningPosition q;
+    CHECK(name, q.parse(p.format()));
+    CHECK(name, q.cells == p.cells && q.scoreX == 2 && q.scoreO == 1 && q.result == 0.5 && q.mode == GameMode::LinesScore);
+    CHECK(name, TuningPosition::isQuiet(b));
+    b.set(3, 2, CellState::X);
+    b.set(3, 1, CellState::X);
+    CHECK(name, !TuningPosition::isQuiet(b));
+
+    GameController gc(6, 6, 4, GameMode::LinesScore);
+    gc.setPositionDump(dumpPath, 2, 7);
+    size_t lines = 0;
+    for (int game = 0; game < 3; ++game) {
+        AIVsAIResult r = gc.runAIVsAIGame(1, true, 1, true, std::string());
+        double expected = r.xWins ? 1.0 : (r.oWins ? 0.0 : 0.5);
+        std::ifstream in(dumpPath);
+        std::string line;
+        size_t seen = 0;
+        while (std::getline(in, line)) {
+            TuningPosition dumped;
+            CHECK(name, dumped.parse(line));
+            if (++seen > lines) CHECK(name, dumped.result == expected && dumped.rows == 6);
+        }
+        lines = seen;
+    }
+    CHECK(name, lines > 0);
+    std::filesystem::remove(weightsPath);
+    std::filesystem::remove(dumpPath);
+}
+
+void testMctsEngine() {
+    const char* name = "testMctsEngine";
+    Board playoutBoard(7, 7, 4);
+    playoutBoard.set(3, 1, CellState::X);
+    playoutBoard.set(3, 2, CellState::X);
+    playoutBoard.set(3, 3, CellState::X);
+    MctsPlayout playout(7, 7, 4, GameMode::Classic);
+    playout.load(playoutBoard);
+    playout.addLineCell(CellState::X, 3 * 7 + 4);
+    uint64_t rng = 1;
+    uint64_t moves = 0;
+    CHECK(name, playout.run(CellState::X, 0, 0, rng, moves) == 1 && moves == 1);
+
+    // A fixed playout budget on one thread repeats exactly.
+    const uint64_t budget = 1500;
+    MoveEvaluation first;
+    AIStatistics firstStats;
+    for (int run = 0; run < 2; ++run) {
+        Board b = makeMidgameBoard();
+        MinimaxAI ai(Player::X, 6, true, GameMode::Classic);
+        ai.setSearchEngine(SearchEngine::Mcts);
+        ai.setUseThreatSearch(false);
+        ai.setDeterministic(true);
+        ai.setNodeLimit(budget);
+        MoveEvaluation eval = ai.findBestMove(b);
+        const AIStatistics& st = ai.getStatistics();
+        CHECK(name, eval.move.row() >= 0 && b.isEmpty(eval.move));
+        CHECK(name, eval.score >= -1000 && eval.score <= 1000);
+        CHECK(name, st.nodes == budget && st.nodeLimitHit);
+        CHECK(name, st.mctsPlayouts > 0 && st.mctsTreeNodes > 1 && st.completedDepth >= 2);
+        if (run == 0) {
+            first = eval;
+            firstStats = st;
+        } else {
+            CHECK(name, eval.move == first.move && eval.score == first.score);
+            CHECK(name, st.searchSignature == firstStats.searchSignature);
+        }
+    }
+
+    // The backend reaches the workers: patterns change the leaves, while the network
+    // (no common scale) falls back to the window counter.
+    Board midgame = makeMidgameBoard();
+    NeuralNet net;
+    net.init(midgame.getRows(), midgame.getCols(), midgame.getWinLength(), GameMode::Classic, 16, 0);
+    net.outputWeight(0) = 1000;
+    MoveEvaluation backends[3];
+    uint64_t signatures[3];
+    for (int backend = 0; backend < 3; ++backend) {
+        Board b = makeMidgameBoard();
+        MinimaxAI ai(Player::X, 6, true, GameMode::Classic);
+        ai.setSearchEngine(SearchEngine::Mcts);
+        ai.setUseThreatSearch(false);
+        ai.setDeterministic(true);
+        ai.setNodeLimit(budget);
+        ai.setNeuralNet(&net);
+        ai.setEvalBackend(backend == 0 ? EvalBackend::Windows : (backend == 1 ? EvalBackend::Patterns : EvalBackend::Neural));
+        backends[backend] = ai.findBestMove(b);
+        signatures[backend] = ai.getStatistics().searchSignature;
+    }
+    CHECK(name, signatures[1] != signatures[0]);
+    CHECK(name, backends[2].move == backends[0].move && backends[2].score == backends[0].score);
+    CHECK(name, signatures[2] == signatures[0]);
+
+    // Tree-parallel threads share the budget exactly.
+    Board shared = makeMidgameBoard();
+    MinimaxAI parallel(Player::O, 6, true, GameMode::Classic);
+    parallel.setSearchEngine(SearchEngine::Mcts);
+    parallel.setUseThreatSearch(false);
+    parallel.setThreadBudget(3);
+    parallel.setNodeLimit(budget);
+    MoveEvaluation p = parallel.findBestMove(shared);
+    CHECK(name, p.move.row() >= 0 && shared.isEmpty(p.move));
+    CHECK(name, parallel.getStatistics().nodes == budget);
+
+    // LinesScore: the priors and playouts both find the completing move.
+    Board lines(7, 7, 4);
+    lines.set(3, 1, CellState::X);
+    lines.set(3, 2, CellState::X);
+    lines.set(3, 3, CellState::X);
+    lines.set(0, 0, CellState::O);
+    lines.set(6, 6, CellState::O);
+    lines.set(0, 6, CellState::O);
+    SearchParams params(4, true);
+    params.setSearchEngine(SearchEngine::Mcts);
+    params.setThreadBudget(1);
+    params.setNodeLimit(2000);
+    AnalysisResult r = analysePosition(lines, Player::X, GameMode::LinesScore, params);
+    CHECK(name, r.bestMove.row() == 3 && (r.bestMove.col() == 0 || r.bestMove.col() == 4));
+    CHECK(name, !r.topMoves.empty() && r.topMoves[0].first == r.bestMove && r.topMoves[0].second == r.bestScore);
+    CHECK(name, r.stats.nodes == 2000);
+}
+
+void testMtdfDriver() {
+    const char* name = "testMtdfDriver";
+    // Zero-window probes converge on the aspiration driver's score.
+    for (int depth = 3; depth <= 4; ++depth) {
+        MoveEvaluation evals[2];
+        for (int mtdf = 0; mtdf < 2; ++mtdf) {
+            Board b = makeMidgameBoard();
+            MinimaxAI ai(Player::X, depth, true, GameMode::Classic);
+            ai.setUseThreatSearch(false);
+            ai.setDeterministic(true);
+            ai.setUseMtdf(mtdf == 1);
+            evals[mtdf] = ai.findBestMove(b);
+            CHECK(name, evals[mtdf].move.row() >= 0 && b.isEmpty(evals[mtdf].move));
+            CHECK(name, (ai.getStatistics().mtdfProbes > 0) == (mtdf == 1));
+            CHECK(name, ai.getStatistics().completedDepth == depth);
+        }
+        CHECK(name, evals[1].score == evals[0].score);
+    }
+
+    // LinesScore: the completing move is found on the wide score scale.
+    Board lines(7, 7, 4);
+    lines.set(3, 1, CellState::X);
+    lines.set(3, 2, CellState::X);
+    lines.set(3, 3, CellState::X);
+    lines.set(0, 0, CellState::O);
+    lines.set(6, 6, CellState::O);
+    lines.set(0, 6, CellState::O);
+    MinimaxAI ai(Player::X, 3, true, GameMode::LinesScore);
+    ai.setUseThreatSearch(false);
+    ai.setUseMtdf(true);
+    MoveEvaluation eval = ai.findBestMove(lines);
+    CHECK(name, eval.move.row() == 3 && (eval.move.col() == 0 || eval.move.col() == 4));
+    CHECK(name, ai.getStatistics().mtdfProbes > 0);
+}
+
+// Random apply/undo sequences keep the incremental gain/threat maps equal to a
+// full rebuild and to trial moves.
+void testIncrementalEvalMaps() {
+    const char* name = "testIncrementalEvalMaps";
+    const GameMode modes[2] = { GameMode::Classic, GameMode::LinesScore };
+    for (int m = 0; m < 2; ++m) {
+        for (uint64_t seed = 1; seed <= 3; ++seed) {
+            Board b(7, 7, 4);
+            MinimaxAI ai(Player::X, 1, false, modes[m]);
+            ai.resetEval(b);
+            DynamicArray<Coord> played;
+            DynamicArray<CellState> sides;
+            uint64_t rng = seed * 0x9e3779b97f4a7c15ULL;
+            CellState toMove = CellState::X;
+            bool ok = ai.evalMapsConsistent(b);
+            for (int step = 0; step < 60 && ok; ++step) {
+                rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+                bool undo = !played.empty() && ((rng >> 33) % 3 == 0 || b.isFull());
+                if (undo) {
+                    Coord mv = played[played.size() - 1];
+                    CellState side = sides[sides.size() - 1];
+                    played.pop_back();
+                    sides.pop_back();
+                    ai.takeBackEval(b, mv, side);
+                    toMove = side;
+                } else {
+                    DynamicArray<Coord> empty = b.getEmptyCells();
+                    Coord mv = empty[static_cast<size_t>((rng >> 33) % empty.size())];
+                    ai.playEval(b, mv, toMove);
+                    played.push_back(mv);
+                    sides.push_back(toMove);
+                    toMove = (toMove == CellState::X) ? CellState::O : CellState::X;
+                }
+                ok = ai.evalMapsConsistent(b);
+            }
+            CHECK(name, ok);
+        }
+    }
+}
+
+void testDeterministicSignature() {
+    const char* name = "testDeterministicSignature";
+    for (int threads = 1; threads <= 4; threads += 3) {
+        MinimaxAI ai(Player::X, 6, true, GameMode::Classic);
+        ai.setThreadBudget(threads);
+        ai.setDeterministic(true);
+        ai.setIterationNodeBudget(30000);
+        ai.setTimeLimitMs(1);
+
+        Board first = makeMidgameBoard();
+        MoveEvaluation a = ai.findBestMove(first);
+        AIStatistics sa = ai.getStatistics();
+
+        Board second = makeMidgameBoard();
+        MoveEvaluation b = ai.findBestMove(second);
+        AIStatistics sb = ai.getStatistics();
+
+        MinimaxAI fresh(Player::X, 6, true, GameMode::Classic);
+        fresh.setThreadBudget(threads);
+        fresh.setDeterministic(true);
+        fresh.setIterationNodeBudget(30000);
+        Board third = makeMidgameBoard();
+        MoveEvaluation c = fresh.findBestMove(third);
+        AIStatistics sc = fresh.getStatistics();
+
+        CHECK(name, a.move.row() >= 0);
+        CHECK(name, sa.completedDepth >= 1);
+        CHECK(name, sa.searchSignature != 0);
+        CHECK(name, a.move == b.move && b.move == c.move);
+        CHECK(name, sa.nodes == sb.nodes && sb.nodes == sc.nodes);
+        CHECK(name, sa.searchSignature == sb.searchSignature);
+        CHECK(name, sb.searchSignature == sc.searchSignature);
+    }
+}
+}
+
+int main() {
+    testCgroupV2Quota();
+    testCgroupV1Quota();
+    testDetectRespectsQuota();
+    testThreadBudgetResolution();
+    testPonderHitAndMiss();
+    testTimeManagerBudgets();
+    testTimeManagerStability();
+    testGameClockCharges();
+    testNodeLimit();
+    testDeadlinePolling();
+    testDeterministicSignature();
+    testThreatSearchVCF();
+    testThreatSearchRejectsDefendedPosition();
+    testThreatSearchVctOnlyOrders();
+    testProofNumberOutcomes();
+    testProofOracleInFindBestMove();
+    testLinesEndgameMatchesBruteForce();
+    testLinesEndgameInFindBestMove();
+    testLineBoundsPruning();
+    testLinesEarlyFinish();
+    testClassicDeadDraw();
+    testDeadCellsPruned();
+    testClassicForcedBlock();
+    testQuiescenceSeesHorizonWin();
+    testNullMoveAndProbCut();
+    testShallowPruning();
+    testStagedMovePicker();
+    testOrderCache();
+    testPersistentHistory();
+    testEvalCache();
+    testPatternEval();
+    testNeuralEval();
+    testEvalWeights();
+    testMctsEngine();
+    testMtdfDriver();
+    testIncrementalEvalMaps();
+
+    if (failures == 0) {
+        std::cout << "All engine tests passed.\n";
+        return 0;
+    }
+    std::cerr << failures << " engine test(s) failed.\n";
+    return 1;
+}
@@ -0,0 +1,347 @@
+#include "GameController.hpp"
+#include "CpuQuota.hpp"
+#include "EvalWeights.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Tuning pipeline for the window evaluator.
+//   eval_tuner selfplay <positions> <rows> <cols> <winLen> <classic|lines> <games> [depth] [timeMs]
+//     plays AI-vs-AI games from random openings and appends their quiet positions,
+//     labelled with the final result, to <positions>.
+//   eval_tuner fit <positions> <weights> [iterations] [threads]
+//     fits the window weights and cell bonuses of every geometry found in
+//     <positions> by Texel-style logistic regression and writes them to <weights>
+//     (blocks already in that file for other geometries are kept).
+
+namespace {
+
+class Sample {
+public:
+    double result = 0.5;
+    double offset = 0.0;
+    double scale = 1.0;
+    DynamicArray<std::pair<int, double>> features;
+};
+
+// Parameters: window weights for 1 .. winLen-1 stones, one bonus per class of cells
+// that the board's symmetries map onto each other, and last a per-stone term. The
+// engine has no such term; it only soaks up the side-to-move bias (X has the extra
+// stone after its move) that would otherwise shift every cell bonus.
+class Group {
+public:
+    int rows = 0;
+    int cols = 0;
+    int winLen = 0;
+    GameMode mode = GameMode::Classic;
+    DynamicArray<int> cellClass;
+    int classCount = 0;
+    DynamicArray<Sample> samples;
+
+    int paramCount() const { return (winLen - 1) + classCount + 1; }
+
+    void buildClasses() {
+        cellClass.clear();
+        DynamicArray<int> representative;
+        for (int i = 0; i < rows * cols; ++i) representative.push_back(-1);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                int best = r * cols + c;
+                int images[8][2] = { { r, c }, { rows - 1 - r, c }, { r, cols - 1 - c }, { rows - 1 - r, cols - 1 - c },
+                                     { c, r }, { cols - 1 - c, r }, { c, rows - 1 - r }, { cols - 1 - c, rows - 1 - r } };
+                int count = (rows == cols) ? 8 : 4;
+                for (int k = 0; k < count; ++k) best = std::min(best, images[k][0] * cols + images[k][1]);
+                representative[r * cols + c] = best;
+            }
+        }
+        DynamicArray<int> classOf;
+        for (int i = 0; i < rows * cols; ++i) classOf.push_back(-1);
+        classCount = 0;
+        for (int i = 0; i < rows * cols; ++i) {
+            int rep = representative[i];
+            if (classOf[rep] < 0) classOf[rep] = classCount++;
+            cellClass.push_back(classOf[rep]);
+        }
+    }
+
+    void addPosition(const TuningPosition& p, int completeWeight) {
+        Sample s;
+        s.result = p.result;
+        s.scale = (mode == GameMode::Classic) ? 1.0 : 0.5;
+        DynamicArray<double> dense;
+        for (int i = 0; i < paramCount(); ++i) dense.push_back(0.0);
+        double complete = 0.0;
+        const int dirs[4][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { 1, -1 } };
+        for (int d = 0; d < 4; ++d) {
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    int er = r + (winLen - 1) * dirs[d][0];
+                    int ec = c + (winLen - 1) * dirs[d][1];
+                    if (er < 0 || er >= rows || ec < 0 || ec >= cols) continue;
+                    int x = 0;
+                    int o = 0;
+                    for (int k = 0; k < winLen; ++k) {
+                        char ch = p.cells[static_cast<size_t>((r + k * dirs[d][0]) * cols + (c + k * dirs[d][1]))];
+                        if (ch == 'X') ++x;
+                        else if (ch == 'O') ++o;
+                    }
+                    if (o == 0 && x > 0) {
+                        if (x < winLen) dense[x - 1] += 1.0;
+                        else complete += completeWeight;
+                    } else if (x == 0 && o > 0) {
+                        if (o < winLen) dense[o - 1] -= 1.0;
+                        else complete -= completeWeight;
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < rows * cols; ++i) {
+            char ch = p.cells[static_cast<size_t>(i)];
+            if (ch == 'X') {
+                dense[(winLen - 1) + cellClass[i]] += 1.0;
+                dense[paramCount() - 1] += 1.0;
+            } else if (ch == 'O') {
+                dense[(winLen - 1) + cellClass[i]] -= 1.0;
+                dense[paramCount() - 1] -= 1.0;
+            }
+        }
+        if (mode == GameMode::LinesScore) s.offset = (p.scoreX - p.scoreO) * 1000.0;
+        s.offset += s.scale * complete;
+        for (int i = 0; i < paramCount(); ++i) {
+            if (dense[i] != 0.0) s.features.push_back(std::pair<int, double>(i, dense[i]));
+        }
+        samples.push_back(s);
+    }
+};
+
+double sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+
+double evalSample(const Sample& s, const DynamicArray<double>& params) {
+    double e = 0.0;
+    for (size_t i = 0; i < s.features.size(); ++i) e += params[static_cast<size_t>(s.features[i].first)] * s.features[i].second;
+    return s.offset + s.scale * e;
+}
+
+// Mean squared error of the predicted results; with grad != nullptr also its gradient.
+// The samples are split across `threads` workers.
+double loss(const Group& g, const DynamicArray<double>& params, double k, int threads, DynamicArray<double>* grad) {
+    size_t n = g.samples.size();
+    int workers = std::max(1, std::min(threads, static_cast<int>(n)));
+    DynamicArray<double> partialLoss;
+    DynamicArray<DynamicArray<double>> partialGrad;
+    for (int t = 0; t < workers; ++t) {
+        partialLoss.push_back(0.0);
+        partialGrad.push_back(DynamicArray<double>());
+        if (grad) {
+            for (int i = 0; i < g.paramCount(); ++i) partialGrad[t].push_back(0.0);
+        }
+    }
+    auto work = [&](int t) {
+        size_t begin = n * static_cast<size_t>(t) / static_cast<size_t>(workers);
+        size_t end = n * static_cast<size_t>(t + 1) / static_cast<size_t>(workers);
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            const Sample& s = g.samples[i];
+            double p = sigmoid(evalSample(s, params) / k);
+            double err = s.result - p;
+            sum += err * err;
+            if (grad) {
+                double d = -2.0 * err * p * (1.0 - p) / k * s.scale;
+                for (size_t f = 0; f < s.features.size(); ++f) {
+                    partialGrad[t][static_cast<size_t>(s.features[f].first)] += d * s.features[f].second;
+                }
+            }
+        }
+        partialLoss[t] = sum;
+    };
+    DynamicArray<std::thread> pool;
+    for (int t = 1; t < workers; ++t) pool.push_back(std::thread(work, t));
+    work(0);
+    for (size_t t = 0; t < pool.size(); ++t) pool[t].join();
+
+    double total = 0.0;
+    for (int t = 0; t < workers; ++t) total += partialLoss[t];
+    if (grad) {
+        grad->clear();
+        for (int i = 0; i < g.paramCount(); ++i) {
+            double sum = 0.0;
+            for (int t = 0; t < workers; ++t) sum += partialGrad[t][i];
+            grad->push_back(sum / static_cast<double>(n));
+        }
+    }
+    return total / static_cast<double>(n);
+}
+
+EvalWeights fit(const Group& g, int iterations, int threads) {
+    EvalWeights base = EvalWeights::defaults(g.rows, g.cols, g.winLen, g.mode, 0);
+    DynamicArray<double> params;
+    for (int n = 1; n < g.winLen; ++n) params.push_back(base.window[n]);
+    DynamicArray<double> classSum;
+    DynamicArray<int> classSize;
+    for (int c = 0; c < g.classCount; ++c) {
+        classSum.push_back(0.0);
+        classSize.push_back(0);
+    }
+    for (int i = 0; i < g.rows * g.cols; ++i) {
+        classSum[g.cellClass[i]] += base.cells[i];
+        classSize[g.cellClass[i]]++;
+    }
+    for (int c = 0; c < g.classCount; ++c) params.push_back(classSum[c] / classSize[c]);
+    params.push_back(0.0);
+
+    // Texel: first the scaling constant that best maps the current evaluation to
+    // results, then the parameters under that constant.
+    double k = 1.0;
+    double bestLoss = loss(g, params, k, threads, nullptr);
+    for (double cand = 2.0; cand <= 100000.0; cand *= 1.25) {
+        double l = loss(g, params, cand, threads, nullptr);
+        if (l < bestLoss) {
+            bestLoss = l;
+            k = cand;
+        }
+    }
+    std::printf("  %d positions, scale %.1f, initial loss %.6f\n", static_cast<int>(g.samples.size()), k, bestLoss);
+
+    const double rate = 1.0;
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    DynamicArray<double> m;
+    DynamicArray<double> v;
+    for (int i = 0; i < g.paramCount(); ++i) {
+        m.push_back(0.0);
+        v.push_back(0.0);
+    }
+    DynamicArray<double> grad;
+    double l = bestLoss;
+    for (int it = 1; it <= iterations; ++it) {
+        l = loss(g, params, k, threads, &grad);
+        for (int i = 0; i < g.paramCount(); ++i) {
+            m[i] = beta1 * m[i] + (1.0 - beta1) * grad[i];
+            v[i] = beta2 * v[i] + (1.0 - beta2) * grad[i] * grad[i];
+            double mh = m[i] / (1.0 - std::pow(beta1, it));
+            double vh = v[i] / (1.0 - std::pow(beta2, it));
+            params[i] -= rate * mh / (std::sqrt(vh) + 1e-12);
+        }
+        if (it % 100 == 0) std::printf("  iteration %d loss %.6f\n", it, l);
+    }
+    std::printf("  final loss %.6f\n", loss(g, params, k, threads, nullptr));
+
+    // The search reads the window weights as a threat scale, so keep them positive,
+    // increasing with the stone count and below a complete window.
+    EvalWeights w = base;
+    int complete = EvalWeights::completeWindow(g.winLen, g.mode);
+    for (int n = 1; n < g.winLen; ++n) {
+        int value = static_cast<int>(std::lround(params[n - 1]));
+        w.window[n] = std::min(std::max(value, w.window[n - 1] + 1), complete - (g.winLen - n));
+    }
+    for (int i = 0; i < g.rows * g.cols; ++i) {
+        w.cells[i] = static_cast<int>(std::lround(params[(g.winLen - 1) + g.cellClass[i]]));
+    }
+    return w;
+}
+
+int runSelfPlay(int argc, char** argv) {
+    if (argc < 8) return 2;
+    std::string out = argv[2];
+    int rows = std::atoi(argv[3]);
+    int cols = std::atoi(argv[4]);
+    int winLen = std::atoi(argv[5]);
+    GameMode mode = (std::string(argv[6]) == "classic") ? GameMode::Classic : GameMode::LinesScore;
+    int games = std::atoi(argv[7]);
+    int depth = (argc > 8) ? std::atoi(argv[8]) : 4;
+    int timeMs = (argc > 9) ? std::atoi(argv[9]) : 200;
+    if (rows <= 0 || cols <= 0 || winLen <= 0 || winLen > std::min(rows, cols) || games <= 0) return 2;
+
+    GameController gc(rows, cols, winLen, mode);
+    gc.setPositionDump(out, 4, 12345);
+    int xWins = 0;
+    int oWins = 0;
+    for (int g = 0; g < games; ++g) {
+        AIVsAIResult r = gc.runAIVsAIGame(depth, true, depth, true, std::string(), nullptr, timeMs, timeMs);
+        if (r.xWins) ++xWins;
+        if (r.oWins) ++oWins;
+        std::printf("game %d/%d: %s\n", g + 1, games, r.xWins ? "X" : (r.oWins ? "O" : "draw"));
+    }
+    std::printf("X %d, O %d, draws %d\n", xWins, oWins, games - xWins - oWins);
+    return 0;
+}
+
+int runFit(int argc, char** argv) {
+    if (argc < 4) return 2;
+    std::ifstream in(argv[2]);
+    if (!in) {
+        std::cerr << "cannot read " << argv[2] << "\n";
+        return 1;
+    }
+    int iterations = (argc > 4) ? std::max(1, std::atoi(argv[4])) : 500;
+    int threads = (argc > 5) ? std::max(1, std::atoi(argv[5]))
+                             : static_cast<int>(std::max(1u, CpuQuota::effectiveCpus()));
+
+    DynamicArray<Group> groups;
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(in, line)) {
+        TuningPosition p;
+        if (!p.parse(line)) {
+            ++skipped;
+            continue;
+        }
+        Group* g = nullptr;
+        for (size_t i = 0; i < groups.size(); ++i) {
+            if (groups[i].rows == p.rows && groups[i].cols == p.cols && groups[i].winLen == p.winLen && groups[i].mode == p.mode) {
+                g = &groups[i];
+            }
+        }
+        if (!g) {
+            Group fresh;
+            fresh.rows = p.rows;
+            fresh.cols = p.cols;
+            fresh.winLen = p.winLen;
+            fresh.mode = p.mode;
+            fresh.buildClasses();
+            groups.push_back(fresh);
+            g = &groups[groups.size() - 1];
+        }
+        // Complete windows only occur in LinesScore positions, where their weight is fixed.
+        EvalWeights base = EvalWeights::defaults(p.rows, p.cols, p.winLen, p.mode, 0);
+        g->addPosition(p, base.window[p.winLen]);
+    }
+    if (skipped > 0) std::printf("skipped %d malformed lines\n", static_cast<int>(skipped));
+
+    EvalWeightSet set;
+    set.load(argv[3]);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        const Group& g = groups[i];
+        if (g.samples.size() < static_cast<size_t>(g.paramCount()) * 10) {
+            std::printf("%dx%d k=%d %s: %d positions, too few to fit\n", g.rows, g.cols, g.winLen,
+                        g.mode == GameMode::Classic ? "classic" : "lines", static_cast<int>(g.samples.size()));
+            continue;
+        }
+        std::printf("%dx%d k=%d %s, %d threads\n", g.rows, g.cols, g.winLen,
+                    g.mode == GameMode::Classic ? "classic" : "lines", threads);
+        set.set(fit(g, iterations, threads));
+    }
+    if (set.empty() || !set.save(argv[3])) {
+        std::cerr << "nothing written to " << argv[3] << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string command = (argc > 1) ? argv[1] : "";
+    int status = 2;
+    if (command == "selfplay") status = runSelfPlay(argc, argv);
+    else if (command == "fit") status = runFit(argc, argv);
+    if (status == 2) {
+        std::cerr << "usage: eval_tuner selfplay <positions> <rows> <cols> <winLen> <classic|lines> <games> [depth] [timeMs]\n"
+                  << "       eval_tuner fit <positions> <weights> [iterations] [threads]\n";
+    }
+    return status;
+}
@@ -111,6 +111,7 @@ MainWindow::MainWindow(QWidget *parent)
     ui->comboEnginePreset->clear();
     ui->comboEnginePreset->addItem("Fast");
     ui->comboEnginePreset->addItem("Strict");
+    ui->comboEnginePreset->addItem("MCTS");
     ui->comboEnginePreset->setCurrentIndex(0);
     ui->comboMoveGenMode->setCurrentIndex(2);
     ui->checkUseLmr->setChecked(true);
@@ -169,6 +170,12 @@ MainWindow::MainWindow(QWidget *parent)
     timeLimitMs_        = ui->spinTimeLimit->value() * 1000;
     openingRule_        = openingRuleFromUi();
     controller_.setOpeningRule(openingRule_);
+    controller_.setPonderEnabled(true);
+    // Neural evaluator weights, if shipped next to the executable.
+    if (controller_.loadEvalWeights((QCoreApplication::applicationDirPath() + "/eval_weights.nnue").toStdString())) {
+        controller_.setEvalBackend(EvalBackend::Neural);
+    }
+    controller_.loadWindowWeights((QCoreApplication::applicationDirPath() + "/window_weights.txt").toStdString());
     hintInProgress_     = false;
     hintCanceled_       = false;
     applyEnginePresetFromUi();
@@ -209,6 +216,7 @@ void MainWindow::stopAllAi(bool resetCancelFlag)
     controller_.setOnAIMoveCallback(nullptr);
     aiCancelFlag_.store(true, std::memory_order_relaxed);
     hintCancelFlag_.store(true, std::memory_order_relaxed);
+    controller_.stopPondering();
 
     bool anyRunning =
         aiWatcher_.isRunning() ||
@@ -1482,13 +1490,18 @@ void MainWindow::onAiSearchFinished()
         double elapsedMs = s.elapsedMs > 0.0 ? s.elapsedMs : static_cast<double>(s.timeMs);
         double nodesSec = elapsedMs > 0.0 ? (static_cast<double>(nodeCount) * 1000.0 / elapsedMs) : 0.0;
         double hitRate = s.ttProbes > 0 ? (100.0 * static_cast<double>(s.ttHits) / static_cast<double>(s.ttProbes)) : 0.0;
+        uint64_t orderProbes = s.orderCacheHits + s.orderCacheMisses;
+        double orderHitRate = orderProbes > 0 ? (100.0 * static_cast<double>(s.orderCacheHits) / static_cast<double>(orderProbes)) : 0.0;
         double avgBefore = nodeCount > 0 ? (static_cast<double>(s.generatedMoves) / static_cast<double>(nodeCount)) : 0.0;
         double avgAfter = nodeCount > 0 ? (static_cast<double>(s.expandedMoves) / static_cast<double>(nodeCount)) : 0.0;
         std::cout << "[AI] nodes/sec=" << nodesSec
                   << " ttHitRate=" << hitRate << "% "
+                  << "orderHitRate=" << orderHitRate << "% "
                   << "avgMoves=" << avgBefore << "/" << avgAfter
                   << " depth=" << s.completedDepth
                   << " timeMs=" << elapsedMs
+                  << " clockPolls=" << s.clockPolls
+                  << " stopLatencyMs=" << s.stopLatencyMs
                   << "\n";
     }
 #endif
@@ -1498,6 +1511,11 @@ void MainWindow::onAiSearchFinished()
         showGameOverMessage();
     } else {
         ui->labelStatus->setText("Игра идёт");
+        if (currentGameType_ == GameType::HumanVsAI && !isCurrentSeatAi()) {
+            int timeLimit = dynamicDepthMode_ ? ui->spinTimeLimit->value() * 1000 : -1;
+            controller_.startPondering(controller_.seatForSide(aiSearchPlayer_), effectiveDepth(),
+                                       ui->checkMemo->isChecked(), timeLimit);
+        }
         autoPlayAiIfNeeded();
     }
 }
@@ -2145,10 +2163,11 @@ void MainWindow::refreshAutoDepthUi()
 
 void MainWindow::applyEnginePresetFromUi()
 {
+    int presetIdx = ui->comboEnginePreset->currentIndex();
     EnginePreset preset =
-        (ui->comboEnginePreset->currentIndex() == 1)
-            ? EnginePreset::Strict
-            : EnginePreset::Fast;
+        (presetIdx == 1) ? EnginePreset::Strict
+        : (presetIdx == 2) ? EnginePreset::Mcts
+        : EnginePreset::Fast;
     controller_.setEnginePreset(preset, ui->spinBoardRows->value(), ui->spinBoardCols->value());
     syncAdvancedSettingsUi(preset);
 }